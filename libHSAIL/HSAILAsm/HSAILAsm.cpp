@@ -61,6 +61,7 @@
 #include "HSAILParser.h"
 #include "HSAILBrigObjectFile.h"
 #include "HSAILValidator.h"
+#include "HSAILValidationCache.h"
 #include "HSAILUtilities.h"
 #include "HSAILDump.h"
 
@@ -108,7 +109,7 @@ static cl::opt<std::string>
     InputFilename(cl::Positional, cl::desc("<input file>"), cl::Required);
 
 static cl::opt<std::string>
-    OutputFilename("o", cl::desc("Output filename (if not specified, input file name with appropriate extension is used)"), cl::value_desc("filename"), cl::init(""));
+    OutputFilename("o", cl::desc("Output filename (if not specified, input file name with appropriate extension is used; '-' means standard output)"), cl::value_desc("filename"), cl::init(""));
 
 static cl::opt<bool>
     Bif32FileFormat("bif32", cl::init(false), cl::desc("generate assembled output in BIF3.0 format using elf32 container"));
@@ -116,12 +117,42 @@ static cl::opt<bool>
 static cl::opt<bool>
     Bif64FileFormat("bif64", cl::init(false), cl::desc("generate assembled output in BIF3.0 format using elf64 container"));
 
+static cl::opt<bool>
+    EmitSymbolIndex("symbol-index", cl::init(false), cl::desc("Add a hash table of module scope symbols to the assembled output"));
+
 static cl::opt<bool>
     DisableOperandOptimizer("disable-operand-optimizer", cl::Hidden, cl::desc("Disable Operand Optimizer"));
 
 static cl::opt<bool>
     DisableValidator("disable-validator", cl::Hidden, cl::desc("Disable Brig Validator"));
 
+static cl::opt<ValidationLevel>
+    ValidationLevelOpt("validation-level", cl::desc("Checks done by Brig Validator:"),
+           cl::init(VALIDATION_FULL),
+           cl::values(clEnumValN(VALIDATION_STRUCTURE, "structure", "sections, item sizes and offsets only (enough for memory safety)"),
+                      clEnumValN(VALIDATION_DEF_USE,   "defuse",    "structure, directives, operands and def/use"),
+                      clEnumValN(VALIDATION_FULL,      "full",      "all the rules (default)"),
+                      clEnumValEnd));
+
+static cl::opt<bool>
+    RecordValidationLevel("record-validation-level", cl::init(false), cl::desc("Record the level the module has been validated at in the assembled output"));
+
+static cl::opt<std::string>
+    ValidationCacheFile("validation-cache", cl::desc("Skip validation of kernels and functions recorded as valid in the file, and record the valid ones"), cl::value_desc("filename"), cl::init(""));
+
+enum ValidatorProfileFormat {
+    ValidatorProfileNone,
+    ValidatorProfileTable,
+    ValidatorProfileJson
+};
+
+static cl::opt<ValidatorProfileFormat>
+    ValidatorProfile("validator-profile", cl::desc("Print time spent in validation phases and instruction rules to standard error (libHSAIL built with HSAIL_VALIDATOR_PROFILE):"),
+           cl::init(ValidatorProfileNone),
+           cl::values(clEnumValN(ValidatorProfileTable, "table", "table sorted by time"),
+                      clEnumValN(ValidatorProfileJson,  "json",  "JSON array sorted by time"),
+                      clEnumValEnd));
+
 static cl::opt<bool>
     ValidateLinkedCode("validate-linked-code", cl::Hidden, cl::desc("Enable validation rules for linked BRIG"));
     // Allows disassembly of linked BRIG with enabled validation
@@ -144,6 +175,7 @@ static cl::opt<EFloatDisassemblyMode>
            cl::values(clEnumValN(FloatDisassemblyModeRawBits,  "floatraw", "print in form 0[DFH]rawbits"),
                       clEnumValN(FloatDisassemblyModeC99,      "floatc99", "print in form +-0xX.XXXp+-DD C99 format"),
                       clEnumValN(FloatDisassemblyModeDecimal,  "floatdec", "print in decimal form"),
+                      clEnumValN(FloatDisassemblyModeShortest, "floatshort", "print in shortest decimal form which reads back exactly"),
                       clEnumValEnd));
 static cl::opt<bool>
     DisasmInstOffset("disasm-inst-offset", cl::Hidden, cl::desc("print Brig instruction offset as comment to an instruction on disassembly"));
@@ -154,6 +186,15 @@ static cl::opt<bool>
 static cl::opt<bool>
     SaveSourceText("include-source", cl::init(false), cl::desc("Save assembly source text in BRIG"));
 
+static cl::opt<bool>
+    PipelineScanner("pipeline-scanner", cl::Hidden, cl::desc("Tokenize the input on a separate thread while parsing"));
+
+static cl::opt<unsigned>
+    ParseThreads("parse-threads", cl::init(1), cl::desc("Parse large modules split at top-level statements on up to N threads"), cl::value_desc("N"));
+
+static cl::opt<unsigned>
+    DisasmThreads("disasm-threads", cl::init(1), cl::desc("Disassemble large modules split at top-level statements on up to N threads"), cl::value_desc("N"));
+
 
 // ============================================================================
 
@@ -174,13 +215,37 @@ static string getOutputFileName(const char* ext) {
     return fileName;
 }
 
-static int ValidateContainer(BrigContainer &c, std::istream *is) {
+static void PrintValidatorProfile(const ValidationProfile& profile) {
+    if (!ValidationProfile::isEnabled()) {
+        std::cerr << "Validator profile is not available: libHSAIL is built without HSAIL_VALIDATOR_PROFILE\n";
+    } else if (ValidatorProfile == ValidatorProfileJson) {
+        profile.printJson(std::cerr);
+    } else {
+        profile.printTable(std::cerr);
+    }
+}
+
+static int ValidateContainer(BrigContainer &c, const SourceLineIndex *lines) {
     if (!DisableValidator) {
         Validator vld(c);
-        if (!vld.validate(DumpFormatError)) {
-            std::cerr << vld.getErrorMsg(is) << '\n';
+        vld.setLevel(ValidationLevelOpt);
+        std::unique_ptr<ValidationCache> cache;
+        if (!ValidationCacheFile.empty()) {
+            cache.reset(new ValidationCache);
+            cache->load(ValidationCacheFile); // a missing or outdated cache is started anew
+            vld.setCache(cache.get());
+        }
+        bool const valid = vld.validate(DumpFormatError);
+        if (ValidatorProfile != ValidatorProfileNone) {
+            PrintValidatorProfile(vld.getProfile());
+        }
+        if (!valid) {
+            std::cerr << (lines ? vld.getErrorMsg(*lines) : vld.getErrorMsg(NULL)) << '\n';
             return vld.getErrorCode();
         }
+        if (cache && !cache->save(ValidationCacheFile)) {
+            std::cerr << "Cannot write validation cache " << ValidationCacheFile << '\n';
+        }
     }
     return 0;
 }
@@ -238,18 +303,23 @@ static int AssembleInput() {
     }
 
     BrigContainer c;
+    Scanner s(ifs,!EnableComments);
+    if (PipelineScanner) s.enablePipelining();
 
     try {
-        Scanner s(ifs,!EnableComments);
         Parser p(s, c);
-        p.parseSource(SaveSourceText);
+        if (ParseThreads > 1) {
+            p.parseSourceParallel(ParseThreads, SaveSourceText);
+        } else {
+            p.parseSource(SaveSourceText);
+        }
     }
     catch (const SyntaxError& e) {
-        e.print(cerr,ifs);
+        e.print(cerr,s.lineIndex());
         return 1;
     }
 
-    int res = ValidateContainer(c, &ifs);
+    int res = ValidateContainer(c, &s.lineIndex());
     if (res) return res;
 
     if ( EnableDebugInfo ) {
@@ -280,13 +350,26 @@ static int AssembleInput() {
                     Bif32FileFormat ? FILE_FORMAT_BIF | FILE_FORMAT_ELF32 :
                     FILE_FORMAT_BRIG;
     const std::string& out = getOutputFileName(fmt==FILE_FORMAT_BRIG ? ".brig" : ".bif");
-    return BrigIO::save(c, fmt, BrigIO::fileWritingAdapter(out.c_str()));
+    if (RecordValidationLevel)
+        recordValidationLevel(c, DisableValidator ? VALIDATION_NONE : static_cast<ValidationLevel>(ValidationLevelOpt));
+
+    int const saveFmt = EmitSymbolIndex ? fmt | FILE_FORMAT_SYMBOL_INDEX : fmt;
+    if (out == "-") {
+        return BrigIO::save(c, saveFmt, BrigIO::stdoutWritingAdapter());
+    }
+    return BrigIO::save(c, saveFmt, BrigIO::fileWritingAdapter(out.c_str()));
 }
 
 static int DisassembleInput() {
     BrigContainer c;
-    if (BrigIO::load(c, FILE_FORMAT_AUTO, 
-                     BrigIO::fileReadingAdapter(InputFilename.c_str()))) {
+    // when the validator is going to run anyway, sections are checked
+    // while reading the file instead of walking them once more afterwards
+    int rc = DisableValidator?
+        BrigIO::load(c, FILE_FORMAT_AUTO,
+                     BrigIO::fileReadingAdapter(InputFilename.c_str())) :
+        BrigIO::loadVerified(c, FILE_FORMAT_AUTO,
+                     BrigIO::fileReadingAdapter(InputFilename.c_str()));
+    if (rc) {
       return 1;
     }
 
@@ -299,6 +382,7 @@ static int DisassembleInput() {
     disasm.setOutputOptions(static_cast<unsigned>(FloatDisassemblyMode)
       | (DisasmInstOffset ? static_cast<unsigned>(Disassembler::PrintInstOffset) : 0u));
     disasm.log(std::cerr);
+    disasm.setNumThreads(DisasmThreads);
 
     if ( DebugInfoFilename.size() > 0 )
         DumpDebugInfoToFile( c );
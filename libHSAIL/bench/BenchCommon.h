@@ -0,0 +1,111 @@
+// University of Illinois/NCSA
+// Open Source License
+//
+// Copyright (c) 2013-2015, Advanced Micro Devices, Inc.
+// All rights reserved.
+//
+// Developed by:
+//
+//     HSA Team
+//
+//     Advanced Micro Devices, Inc
+//
+//     www.amd.com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the "Software"), to deal with
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+//     * Redistributions of source code must retain the above copyright notice,
+//       this list of conditions and the following disclaimers.
+//
+//     * Redistributions in binary form must reproduce the above copyright notice,
+//       this list of conditions and the following disclaimers in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the names of the LLVM Team, University of Illinois at
+//       Urbana-Champaign, nor the names of its contributors may be used to
+//       endorse or promote products derived from this Software without specific
+//       prior written permission.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS WITH THE
+// SOFTWARE.
+#pragma once
+#ifndef INCLUDED_HSAIL_BENCH_COMMON_H
+#define INCLUDED_HSAIL_BENCH_COMMON_H
+
+// Command line handling and input loading shared by the benchmarks which
+// run over HSAIL files: "[-n repeats] file.hsail...". The test corpus is in
+// tests/*.hsail.
+
+#include "HSAILParser.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+namespace HSAIL_ASM
+{
+
+/// parses "[-n repeats] file.hsail..."; -n is only accepted if n is not
+/// NULL, which receives defaultN if there is no -n. name is what the usage
+/// calls the number. Returns the index of the first file in argv, or 0
+/// after printing the usage.
+inline int parseBenchArgs(int argc, char** argv, int* n, int defaultN = 5, const char* name = "repeats")
+{
+    int first = 1;
+    if (n) {
+        *n = defaultN;
+        if (argc > 2 && strcmp(argv[1], "-n") == 0) {
+            *n = atoi(argv[2]);
+            first = 3;
+        }
+    }
+    if (first >= argc || (n && *n < 1)) {
+        std::cerr << "usage: " << argv[0];
+        if (n) std::cerr << " [-n " << name << "]";
+        std::cerr << " file.hsail..." << std::endl;
+        return 0;
+    }
+    return first;
+}
+
+/// opens the file for binary reading, false after reporting an error
+inline bool openBenchFile(const char* fileName, std::ifstream& ifs)
+{
+    ifs.open(fileName, std::ios::binary);
+    if (!ifs) {
+        std::cerr << "cannot open " << fileName << std::endl;
+        return false;
+    }
+    return true;
+}
+
+/// assembles the file into c, false after reporting an error
+inline bool assembleBenchFile(const char* fileName, BrigContainer& c)
+{
+    std::ifstream ifs;
+    if (!openBenchFile(fileName, ifs)) return false;
+    Scanner s(ifs, true);
+    try {
+        Parser p(s, c);
+        p.parseSource();
+    } catch (const SyntaxError& e) {
+        e.print(std::cerr, s.lineIndex());
+        return false;
+    }
+    return true;
+}
+
+} // end namespace
+
+#endif
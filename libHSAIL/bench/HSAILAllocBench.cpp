@@ -0,0 +1,98 @@
+// University of Illinois/NCSA
+// Open Source License
+//
+// Copyright (c) 2013-2015, Advanced Micro Devices, Inc.
+// All rights reserved.
+//
+// Developed by:
+//
+//     HSA Team
+//
+//     Advanced Micro Devices, Inc
+//
+//     www.amd.com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the "Software"), to deal with
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+//     * Redistributions of source code must retain the above copyright notice,
+//       this list of conditions and the following disclaimers.
+//
+//     * Redistributions in binary form must reproduce the above copyright notice,
+//       this list of conditions and the following disclaimers in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the names of the LLVM Team, University of Illinois at
+//       Urbana-Champaign, nor the names of its contributors may be used to
+//       endorse or promote products derived from this Software without specific
+//       prior written permission.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS WITH THE
+// SOFTWARE.
+
+// Counts heap allocations made while assembling HSAIL sources, overall and
+// per instruction. Usage: hsail-alloc-bench file.hsail...
+
+#include "BenchCommon.h"
+#include "HSAILItems.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+static size_t numAllocs = 0;
+
+void* operator new(size_t size)
+{
+    ++numAllocs;
+    if (void* p = malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept
+{
+    free(p);
+}
+
+void operator delete(void* p, size_t) noexcept
+{
+    free(p);
+}
+
+using namespace HSAIL_ASM;
+
+int main(int argc, char** argv)
+{
+    int const first = parseBenchArgs(argc, argv, NULL);
+    if (!first) return 1;
+    size_t totalAllocs = 0, totalInsts = 0;
+    for(int i = first; i < argc; ++i) {
+        BrigContainer c;
+        size_t const before = numAllocs;
+        if (!assembleBenchFile(argv[i], c)) return 1;
+        size_t const allocs = numAllocs - before;
+
+        size_t insts = 0;
+        for(Code d = c.code().begin(); d != c.code().end(); d = d.next()) {
+            if (Inst(d)) ++insts;
+        }
+        printf("%s: %zu allocations, %zu instructions, %.2f per instruction\n",
+            argv[i], allocs, insts, insts ? (double)allocs / insts : 0.0);
+        totalAllocs += allocs;
+        totalInsts += insts;
+    }
+    if (argc > 2) {
+        printf("total: %zu allocations, %zu instructions, %.2f per instruction\n",
+            totalAllocs, totalInsts, totalInsts ? (double)totalAllocs / totalInsts : 0.0);
+    }
+    return 0;
+}
@@ -0,0 +1,96 @@
+// University of Illinois/NCSA
+// Open Source License
+//
+// Copyright (c) 2013-2015, Advanced Micro Devices, Inc.
+// All rights reserved.
+//
+// Developed by:
+//
+//     HSA Team
+//
+//     Advanced Micro Devices, Inc
+//
+//     www.amd.com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the "Software"), to deal with
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+//     * Redistributions of source code must retain the above copyright notice,
+//       this list of conditions and the following disclaimers.
+//
+//     * Redistributions in binary form must reproduce the above copyright notice,
+//       this list of conditions and the following disclaimers in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the names of the LLVM Team, University of Illinois at
+//       Urbana-Champaign, nor the names of its contributors may be used to
+//       endorse or promote products derived from this Software without specific
+//       prior written permission.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS WITH THE
+// SOFTWARE.
+
+// Measures disassembler throughput in bytes of text per second, printing
+// to a string through OutputBuffer and to a std::ostream, for each float
+// disassembly mode. Usage: hsail-disasm-bench [-n repeats] file.hsail...
+
+#include "BenchCommon.h"
+#include "HSAILDisassembler.h"
+
+#include <chrono>
+#include <cstdio>
+#include <sstream>
+
+using namespace HSAIL_ASM;
+
+static double disasmTime(BrigContainer& c, unsigned mode, bool toStream, int repeats, size_t& size)
+{
+    double best = 0;
+    for(int i = 0; i < repeats; ++i) {
+        Disassembler d(c);
+        d.setOutputOptions(mode);
+        std::string text;
+        std::ostringstream os;
+        std::chrono::steady_clock::time_point const start = std::chrono::steady_clock::now();
+        if (toStream) {
+            d.run(os);
+        } else {
+            OutputBuffer out(text);
+            d.run(out);
+        }
+        double const t = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        size = toStream ? os.str().size() : text.size();
+        if (i == 0 || t < best) best = t;
+    }
+    return best;
+}
+
+int main(int argc, char** argv)
+{
+    int repeats;
+    int const first = parseBenchArgs(argc, argv, &repeats);
+    if (!first) return 1;
+    static const char* const modeNames[] = { "floatraw", "floatc99", "floatdec", "floatshort" };
+    for(int i = first; i < argc; ++i) {
+        BrigContainer c;
+        if (!assembleBenchFile(argv[i], c)) return 1;
+
+        for(unsigned mode = FloatDisassemblyModeRawBits; mode <= FloatDisassemblyModeShortest; ++mode) {
+            size_t size = 0;
+            double const buffer = disasmTime(c, mode, false, repeats, size);
+            double const stream = disasmTime(c, mode, true, repeats, size);
+            printf("%s %s: %zu bytes, buffer %.1f MB/s, ostream %.1f MB/s\n", argv[i], modeNames[mode], size,
+                size / buffer / 1e6, size / stream / 1e6);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,189 @@
+// University of Illinois/NCSA
+// Open Source License
+//
+// Copyright (c) 2013-2015, Advanced Micro Devices, Inc.
+// All rights reserved.
+//
+// Developed by:
+//
+//     HSA Team
+//
+//     Advanced Micro Devices, Inc
+//
+//     www.amd.com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the "Software"), to deal with
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+//     * Redistributions of source code must retain the above copyright notice,
+//       this list of conditions and the following disclaimers.
+//
+//     * Redistributions in binary form must reproduce the above copyright notice,
+//       this list of conditions and the following disclaimers in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the names of the LLVM Team, University of Illinois at
+//       Urbana-Champaign, nor the names of its contributors may be used to
+//       endorse or promote products derived from this Software without specific
+//       prior written permission.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS WITH THE
+// SOFTWARE.
+
+// Checks that the float literals printed by the disassembler read back
+// exactly through the Scanner and times their conversion. Shortest decimal
+// and C99 literals are checked for all finite f16 values, and for a
+// pseudo-random set of f32 and f64 values with the powers of 2 and their
+// neighbours. Reports ns per literal for both forms and for printf with
+// enough digits to round-trip. Returns non-zero on a mismatch.
+// Usage: hsail-float-bench [-n count]
+
+#include "HSAILScanner.h"
+#include "HSAILFloats.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace HSAIL_ASM;
+
+static f16_t readFloatLiteral(Scanner& s, f16_t) { return s.readF16Literal(); }
+static f32_t readFloatLiteral(Scanner& s, f32_t) { return s.readF32Literal(); }
+static f64_t readFloatLiteral(Scanner& s, f64_t) { return s.readF64Literal(); }
+
+static const char* typeName(f16_t) { return "f16"; }
+static const char* typeName(f32_t) { return "f32"; }
+static const char* typeName(f64_t) { return "f64"; }
+
+// printf digits which are enough for any value to round-trip
+static int printfDigits(f16_t) { return 5; }
+static int printfDigits(f32_t) { return 9; }
+static int printfDigits(f64_t) { return 17; }
+
+template <typename Float>
+static bool isFinite(Float v)
+{
+    return (v.rawBits() & IEEE754Traits<Float>::expMask) != IEEE754Traits<Float>::expMask;
+}
+
+// finite pseudo-random values, powers of 2 and their neighbours
+template <typename Float>
+static std::vector<Float> testValues(unsigned count)
+{
+    typedef IEEE754Traits<Float> Traits;
+    typedef typename Traits::RawBitsType RawBits;
+
+    std::vector<Float> values;
+    uint64_t x = 0x9E3779B97F4A7C15ULL;
+    for(unsigned i = 0; i < count; ++i) {
+        x = x * 6364136223846793005ULL + 1442695040888963407ULL;
+        Float const v = Float::fromRawBits(static_cast<RawBits>(x >> (64 - Traits::width)));
+        if (isFinite(v)) values.push_back(v);
+    }
+    for(RawBits e = 0; e < (Traits::expMask >> Traits::mntsWidth); ++e) {
+        RawBits const pow2 = e << Traits::mntsWidth;
+        values.push_back(Float::fromRawBits(pow2));
+        values.push_back(Float::fromRawBits(pow2 | 1));
+        values.push_back(Float::fromRawBits(pow2 | Traits::mntsMask));
+    }
+    return values;
+}
+
+static std::vector<f16_t> allF16()
+{
+    std::vector<f16_t> values;
+    for(unsigned bits = 0; bits <= 0xFFFF; ++bits) {
+        f16_t const v = f16_t::fromRawBits(static_cast<uint16_t>(bits));
+        if (isFinite(v)) values.push_back(v);
+    }
+    return values;
+}
+
+// literals written by toLiteral are read back through the scanner
+template <typename Float, typename ToLiteral>
+static size_t checkLiterals(const std::vector<Float>& values, ToLiteral toLiteral)
+{
+    std::string text;
+    for(size_t i = 0; i < values.size(); ++i) {
+        char buf[MAX_FLOAT_LITERAL_LEN];
+        text.append(buf, toLiteral(values[i], buf));
+        text += '\n';
+    }
+
+    std::istringstream is(text);
+    Scanner s(is);
+    size_t mismatch = 0;
+    size_t i = 0;
+    try {
+        for(; i < values.size(); ++i) {
+            if (readFloatLiteral(s, values[i]) != values[i]) {
+                if (mismatch++ == 0) std::cerr << "Mismatch on " << typeName(values[i]) << " literal " << s.token().text() << std::endl;
+            }
+        }
+    } catch (const SyntaxError& e) {
+        std::cerr << "Invalid " << typeName(values[i]) << " literal: " << e.what() << std::endl;
+        ++mismatch;
+    }
+    return mismatch;
+}
+
+template <typename Fn>
+static double timeLiterals(size_t num, Fn fn)
+{
+    size_t length = 0;
+    std::chrono::steady_clock::time_point const start = std::chrono::steady_clock::now();
+    for(size_t i = 0; i < num; ++i) length += fn(i);
+    std::chrono::duration<double, std::nano> const elapsed = std::chrono::steady_clock::now() - start;
+    if (length == 0) std::cerr << "no output" << std::endl; // keeps the loop
+    return num == 0 ? 0 : elapsed.count() / num;
+}
+
+template <typename Float>
+static bool report(const std::vector<Float>& values)
+{
+    size_t const shortMismatch = checkLiterals(values, [](Float v, char* buf) { return toShortestDecimal(v, buf); });
+    size_t const c99Mismatch = checkLiterals(values, [](Float v, char* buf) { return toC99chars(v, buf); });
+
+    char buf[64];
+    double const shortNs = timeLiterals(values.size(), [&](size_t i) { return toShortestDecimal(values[i], buf); });
+    double const c99Ns = timeLiterals(values.size(), [&](size_t i) { return toC99chars(values[i], buf); });
+    double const printfNs = timeLiterals(values.size(), [&](size_t i) {
+        return (size_t)snprintf(buf, sizeof buf, "%.*g", printfDigits(values[i]), (double)values[i].floatValue()); });
+
+    printf("%s: %zu values, shortest %.1f ns/literal, c99 %.1f ns/literal (printf: %.1f ns/literal)",
+        typeName(Float()), values.size(), shortNs, c99Ns, printfNs);
+    if (shortMismatch) printf(", %zu shortest mismatches", shortMismatch);
+    if (c99Mismatch)   printf(", %zu c99 mismatches", c99Mismatch);
+    printf("\n");
+    return shortMismatch == 0 && c99Mismatch == 0;
+}
+
+int main(int argc, char** argv)
+{
+    unsigned count = 200000;
+    if (argc == 3 && strcmp(argv[1], "-n") == 0) {
+        count = (unsigned)atoi(argv[2]);
+    } else if (argc != 1) {
+        std::cerr << "usage: " << argv[0] << " [-n count]" << std::endl;
+        return 1;
+    }
+    bool ok = true;
+    ok &= report(allF16());
+    ok &= report(testValues<f32_t>(count));
+    ok &= report(testValues<f64_t>(count));
+    return ok ? 0 : 1;
+}
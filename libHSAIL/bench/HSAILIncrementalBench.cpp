@@ -0,0 +1,226 @@
+// University of Illinois/NCSA
+// Open Source License
+//
+// Copyright (c) 2013-2015, Advanced Micro Devices, Inc.
+// All rights reserved.
+//
+// Developed by:
+//
+//     HSA Team
+//
+//     Advanced Micro Devices, Inc
+//
+//     www.amd.com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the "Software"), to deal with
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+//     * Redistributions of source code must retain the above copyright notice,
+//       this list of conditions and the following disclaimers.
+//
+//     * Redistributions in binary form must reproduce the above copyright notice,
+//       this list of conditions and the following disclaimers in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the names of the LLVM Team, University of Illinois at
+//       Urbana-Champaign, nor the names of its contributors may be used to
+//       endorse or promote products derived from this Software without specific
+//       prior written permission.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS WITH THE
+// SOFTWARE.
+
+// Checks that IncrementalParser gives the same sections as a full parse and
+// times both. For a spread of top-level statements of each file, the text
+// is edited around the statement and parsed incrementally after the
+// original: a new line before the statement moves the following ones down,
+// a blank before its ';' re-parses it in place. The code and operand
+// sections and the source positions of the items are compared byte for
+// byte with a full parse of the edited text, and again after parsing the
+// original back. The data section keeps the strings of replaced statements,
+// so references to it are compared by the bytes they refer to instead.
+// Returns non-zero on a mismatch.
+// Usage: hsail-incremental-bench [-n statements] file.hsail...
+
+#include "BenchCommon.h"
+#include "HSAILItems.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace HSAIL_ASM;
+
+static double seconds(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+template <typename Item>
+static bool sameSourceInfo(const BrigSectionImpl& a, const BrigSectionImpl& b)
+{
+    for(Item i(const_cast<BrigSectionImpl*>(&a), a.secHeader()->headerByteCount); i.brigOffset() < a.size(); i = i.next()) {
+        const SourceInfo* const x = a.sourceInfo(i.brigOffset());
+        const SourceInfo* const y = b.sourceInfo(i.brigOffset());
+        if (!x != !y || (x && (x->line != y->line || x->column != y->column))) return false;
+    }
+    return true;
+}
+
+// positions of the data section references in the items of a section
+class DataRefs
+{
+public:
+    explicit DataRefs(BrigSectionImpl& s) : m_base(s.getData<char>(0)) {}
+
+    std::vector<Offset> positions;
+
+    void operator()(StrRef ref, ...) { add(ref.deref()); }
+
+    template <typename I>
+    void operator()(ListRef<I> list, ...) { add(list.deref()); }
+
+    template <typename T>
+    void operator()(const T&, ...) {} // all others
+
+private:
+    const char* m_base;
+
+    void add(const Offset& ofs) { positions.push_back((Offset)((const char*)&ofs - m_base)); }
+};
+
+// compares the section of a with the one of b assuming the same layout,
+// data references are compared by the bytes they refer to
+template <typename Item>
+static bool sameItems(BrigContainer& a, BrigContainer& b, int section)
+{
+    BrigSectionImpl& x = a.sectionById(section);
+    BrigSectionImpl& y = b.sectionById(section);
+    if (x.size() != y.size()) return false;
+
+    DataRefs refs(x);
+    for(Item i(&x, x.secHeader()->headerByteCount); i.brigOffset() < x.size(); i = i.next()) {
+        enumerateFields(i, refs);
+    }
+    std::vector<char> xBytes(x.getData<char>(0), x.getData<char>(x.size()));
+    std::vector<char> yBytes(y.getData<char>(0), y.getData<char>(y.size()));
+    for(size_t i = 0; i < refs.positions.size(); ++i) {
+        Offset* const xOfs = (Offset*)&xBytes[refs.positions[i]];
+        Offset* const yOfs = (Offset*)&yBytes[refs.positions[i]];
+        if ((*xOfs == 0) != (*yOfs == 0)) return false;
+        if (*xOfs != 0 && a.strings().getString(*xOfs) != b.strings().getString(*yOfs)) return false;
+        *xOfs = *yOfs = 0;
+    }
+    return xBytes == yBytes;
+}
+
+static bool sameSections(BrigContainer& a, BrigContainer& b, const char* what)
+{
+    if (!sameItems<Code>(a, b, BRIG_SECTION_INDEX_CODE) || !sameItems<Operand>(a, b, BRIG_SECTION_INDEX_OPERAND)) {
+        std::cerr << what << ": items differ from a full parse" << std::endl;
+        return false;
+    }
+    if (!sameSourceInfo<Code>(a.code(), b.code()) || !sameSourceInfo<Operand>(a.operands(), b.operands())) {
+        std::cerr << what << ": source positions differ from a full parse" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+struct Times
+{
+    double full, update;
+    size_t updates, incremental;
+};
+
+// parses the text incrementally and in full, compares the results
+static bool check(IncrementalParser& inc, BrigContainer& c, const std::string& text, const char* what, Times& t)
+{
+    BrigContainer ref;
+    try {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        inc.parse(text);
+        t.update += seconds(start);
+
+        std::istringstream is(text);
+        Scanner s(is, true);
+        Parser p(s, ref);
+        start = std::chrono::steady_clock::now();
+        p.parseSource();
+        t.full += seconds(start);
+    } catch (const SyntaxError& e) {
+        std::istringstream is(text);
+        std::cerr << what << ": ";
+        e.print(std::cerr, is);
+        return false;
+    }
+    ++t.updates;
+    if (inc.numParsed() == 1) ++t.incremental;
+    return sameSections(c, ref, what);
+}
+
+static bool checkFile(const char* fileName, unsigned count)
+{
+    std::ifstream ifs;
+    if (!openBenchFile(fileName, ifs)) return false;
+    std::stringstream ss;
+    ss << ifs.rdbuf();
+    std::string const text = ss.str();
+
+    TopLevelSplitter splitter(text.data(), text.data() + text.size(), false);
+    if (!splitter.split() || splitter.stmtEnds.size() < 2) {
+        std::cerr << fileName << ": no top-level statements to edit" << std::endl;
+        return false;
+    }
+    size_t const numStmts = splitter.stmtEnds.size();
+
+    BrigContainer c;
+    IncrementalParser inc(c);
+    Times t = { 0, 0, 0, 0 };
+    if (!check(inc, c, text, fileName, t)) return false;
+    t = Times(); // only the updates after edits are timed
+
+    bool ok = true;
+    size_t const step = (std::max)((numStmts - 1) / count, (size_t)1);
+    for(size_t i = 1; i < numStmts; i += step) {
+        size_t const begin = splitter.stmtEnds[i - 1], end = splitter.stmtEnds[i];
+        std::string moved(text);
+        moved.insert(begin, "\n");
+        std::string blank(text);
+        blank.insert(end - 1, " ");
+        std::ostringstream what;
+        what << fileName << ": statement " << i;
+        ok &= check(inc, c, moved, (what.str() + " moved").c_str(), t);
+        ok &= check(inc, c, text, (what.str() + " moved back").c_str(), t);
+        ok &= check(inc, c, blank, (what.str() + " blank").c_str(), t);
+        ok &= check(inc, c, text, (what.str() + " blank removed").c_str(), t);
+    }
+    printf("%s: %zu statements, %zu updates (%zu incremental), full parse %.3f ms, update %.3f ms\n",
+        fileName, numStmts, t.updates, t.incremental, t.full / t.updates * 1e3, t.update / t.updates * 1e3);
+    return ok;
+}
+
+int main(int argc, char** argv)
+{
+    int count;
+    int const first = parseBenchArgs(argc, argv, &count, 8, "statements");
+    if (!first) return 1;
+    bool ok = true;
+    for(int i = first; i < argc; ++i) {
+        ok &= checkFile(argv[i], (unsigned)count);
+    }
+    return ok ? 0 : 1;
+}
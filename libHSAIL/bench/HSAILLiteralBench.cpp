@@ -0,0 +1,206 @@
+// University of Illinois/NCSA
+// Open Source License
+//
+// Copyright (c) 2013-2015, Advanced Micro Devices, Inc.
+// All rights reserved.
+//
+// Developed by:
+//
+//     HSA Team
+//
+//     Advanced Micro Devices, Inc
+//
+//     www.amd.com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the "Software"), to deal with
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+//     * Redistributions of source code must retain the above copyright notice,
+//       this list of conditions and the following disclaimers.
+//
+//     * Redistributions in binary form must reproduce the above copyright notice,
+//       this list of conditions and the following disclaimers in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the names of the LLVM Team, University of Illinois at
+//       Urbana-Champaign, nor the names of its contributors may be used to
+//       endorse or promote products derived from this Software without specific
+//       prior written permission.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS WITH THE
+// SOFTWARE.
+
+// Times numeric literal conversion by the Scanner helpers against the
+// stream based conversion they replaced. Literals are picked from the input
+// files and extended with a synthetic numeric-heavy set; the results of both
+// conversions are compared. Usage: hsail-literal-bench [file.hsail...]
+
+#include "BenchCommon.h"
+
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <strstream>
+#include <vector>
+
+using namespace HSAIL_ASM;
+using std::string;
+
+namespace {
+
+enum LiteralKind { LitDec, LitOct, LitHex, LitFloat, LitDouble, LitKindCount };
+
+const char* const literalKindNames[LitKindCount] = { "decimal", "octal", "hex", "float", "double" };
+
+struct LiteralCorpus {
+    std::vector<string> lits[LitKindCount];
+};
+
+bool isLitChar(char c) {
+    return isalnum((unsigned char)c) || c == '.' || c == '_';
+}
+
+void classifyLiteral(const string& t, LiteralCorpus& corpus) {
+    if (t.size() > 2 && t[0] == '0' && (t[1] == 'x' || t[1] == 'X')) {
+        if (t.find_first_not_of("0123456789abcdefABCDEF", 2) == string::npos)
+            corpus.lits[LitHex].push_back(t.substr(2));
+    } else if (t.find_first_not_of("0123456789") == string::npos) {
+        if (t.size() > 1 && t[0] == '0') {
+            if (t.find_first_not_of("01234567") == string::npos)
+                corpus.lits[LitOct].push_back(t.substr(1));
+        } else {
+            corpus.lits[LitDec].push_back(t);
+        }
+    } else if (t.find_first_not_of("0123456789.eE+-") == string::npos &&
+               t.find('.') != string::npos) {
+        corpus.lits[LitFloat].push_back(t);
+        corpus.lits[LitDouble].push_back(t);
+    }
+}
+
+void collectLiterals(const string& text, LiteralCorpus& corpus) {
+    for(size_t i = 0; i < text.size();) {
+        if (!isdigit((unsigned char)text[i]) || (i > 0 && (isLitChar(text[i-1]) || text[i-1] == '$'))) { ++i; continue; }
+        size_t j = i;
+        while (j < text.size()) {
+            char const c = text[j];
+            if (isLitChar(c)) { ++j; continue; }
+            if ((c == '+' || c == '-') && (text[j-1] == 'e' || text[j-1] == 'E') && text[i] != '0') { ++j; continue; }
+            break;
+        }
+        classifyLiteral(text.substr(i, j - i), corpus);
+        i = j;
+    }
+}
+
+void generateLiterals(LiteralCorpus& corpus, unsigned count) {
+    unsigned long long x = 0x9E3779B97F4A7C15ULL;
+    char buf[64];
+    for(unsigned i = 0; i < count; ++i) {
+        x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+        unsigned long long const v = x >> (i % 64);
+        sprintf(buf, "%llu", v);  corpus.lits[LitDec].push_back(buf);
+        sprintf(buf, "%llo", v);  corpus.lits[LitOct].push_back(buf);
+        sprintf(buf, "%llx", v);  corpus.lits[LitHex].push_back(buf);
+        sprintf(buf, "%u.%0*u", (unsigned)(v % 100000), (int)(i % 6) + 1, (unsigned)(v >> 40) % 1000000);
+        corpus.lits[LitFloat].push_back(buf);
+        sprintf(buf, "%.*e", (int)(i % 15), (double)(v % 1000000007) * 1e-5);
+        corpus.lits[LitDouble].push_back(buf);
+    }
+}
+
+template <typename T, typename Fn>
+double timeLiterals(const std::vector<string>& lits, std::vector<T>& res, Fn fn) {
+    res.resize(lits.size());
+    std::chrono::steady_clock::time_point const start = std::chrono::steady_clock::now();
+    for(size_t i = 0; i < lits.size(); ++i) res[i] = fn(lits[i]);
+    std::chrono::duration<double, std::nano> const elapsed = std::chrono::steady_clock::now() - start;
+    return lits.empty() ? 0 : elapsed.count() / lits.size();
+}
+
+template <typename T>
+T streamConvert(const string& s, std::ios_base& (*base)(std::ios_base&)) {
+    T v = T();
+    std::istrstream is(s.data(), s.size());
+    is >> base >> v;
+    return v;
+}
+
+template <typename T>
+T fastInteger(const string& s, bool (*parse)(const SRef&, uint64_t&)) {
+    uint64_t v = 0;
+    parse(SRef(s), v);
+    return v;
+}
+
+template <typename T>
+T fastFloat(const string& s) {
+    T v;
+    if (!parseDecFloatFast(SRef(s), v)) v = streamConvert<T>(s, std::dec);
+    return v;
+}
+
+template <typename T, typename Fast, typename Ref>
+bool reportLiterals(LiteralKind kind, const LiteralCorpus& corpus, Fast fast, Ref ref) {
+    std::vector<T> fastRes, refRes;
+    const std::vector<string>& lits = corpus.lits[kind];
+    double const fastNs = timeLiterals(lits, fastRes, fast);
+    double const refNs  = timeLiterals(lits, refRes, ref);
+    size_t mismatch = 0;
+    for(size_t i = 0; i < lits.size(); ++i) {
+        if (fastRes[i] != refRes[i] && !(fastRes[i] != fastRes[i] && refRes[i] != refRes[i])) {
+            if (mismatch++ == 0) std::cerr << "Mismatch on " << literalKindNames[kind] << " literal " << lits[i] << std::endl;
+        }
+    }
+    std::cout << literalKindNames[kind] << ": " << lits.size() << " literals, "
+              << fastNs << " ns/literal (stream: " << refNs << " ns/literal)";
+    if (mismatch) std::cout << ", " << mismatch << " mismatches";
+    std::cout << std::endl;
+    return mismatch == 0;
+}
+
+} // end anonymous namespace
+
+
+int main(int argc, char** argv)
+{
+    LiteralCorpus corpus;
+    for(int i = 1; i < argc; ++i) {
+        std::ifstream ifs;
+        if (!openBenchFile(argv[i], ifs)) return 1;
+        std::stringstream ss;
+        ss << ifs.rdbuf();
+        collectLiterals(ss.str(), corpus);
+    }
+    generateLiterals(corpus, 200000);
+
+    bool ok = true;
+    ok &= reportLiterals<uint64_t>(LitDec, corpus,
+            [](const string& s) { return fastInteger<uint64_t>(s, parseDecDigits); },
+            [](const string& s) { return streamConvert<uint64_t>(s, std::dec); });
+    ok &= reportLiterals<uint64_t>(LitOct, corpus,
+            [](const string& s) { return fastInteger<uint64_t>(s, parseOctDigits); },
+            [](const string& s) { return streamConvert<uint64_t>(s, std::oct); });
+    ok &= reportLiterals<uint64_t>(LitHex, corpus,
+            [](const string& s) { return fastInteger<uint64_t>(s, parseHexDigits); },
+            [](const string& s) { return streamConvert<uint64_t>(s, std::hex); });
+    ok &= reportLiterals<float>(LitFloat, corpus,
+            [](const string& s) { return fastFloat<float>(s); },
+            [](const string& s) { return streamConvert<float>(s, std::dec); });
+    ok &= reportLiterals<double>(LitDouble, corpus,
+            [](const string& s) { return fastFloat<double>(s); },
+            [](const string& s) { return streamConvert<double>(s, std::dec); });
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,110 @@
+// University of Illinois/NCSA
+// Open Source License
+//
+// Copyright (c) 2013-2015, Advanced Micro Devices, Inc.
+// All rights reserved.
+//
+// Developed by:
+//
+//     HSA Team
+//
+//     Advanced Micro Devices, Inc
+//
+//     www.amd.com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the "Software"), to deal with
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+//     * Redistributions of source code must retain the above copyright notice,
+//       this list of conditions and the following disclaimers.
+//
+//     * Redistributions in binary form must reproduce the above copyright notice,
+//       this list of conditions and the following disclaimers in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the names of the LLVM Team, University of Illinois at
+//       Urbana-Champaign, nor the names of its contributors may be used to
+//       endorse or promote products derived from this Software without specific
+//       prior written permission.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS WITH THE
+// SOFTWARE.
+
+// Measures assembler front end throughput in bytes of HSAIL text per
+// second. Each file is parsed into a scratch container once per byte
+// search implementation supported by the cpu, so the effect of vectorized
+// blank and comment skipping can be compared, and once more with the
+// scanner pipelined. Usage: hsail-scanner-bench [-n repeats] file.hsail...
+
+#include "BenchCommon.h"
+#include "HSAILCharScan.h"
+
+#include <chrono>
+#include <cstdio>
+
+using namespace HSAIL_ASM;
+
+static size_t parseTime(std::istream& is, bool pipelined, double& seconds)
+{
+    BrigContainer c;
+    Scanner s(is, true);
+    if (pipelined) s.enablePipelining();
+    Parser p(s, c);
+    std::chrono::steady_clock::time_point const start = std::chrono::steady_clock::now();
+    p.parseSource();
+    seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return s.lineIndex().numLines();
+}
+
+static bool bestParseTime(std::istream& is, bool pipelined, int repeats, double& best, size_t& lines)
+{
+    try {
+        for(int i = 0; i < repeats; ++i) {
+            double seconds;
+            lines = parseTime(is, pipelined, seconds);
+            if (i == 0 || seconds < best) best = seconds;
+        }
+    } catch (const SyntaxError& e) {
+        e.print(std::cerr, is);
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    int repeats;
+    int const first = parseBenchArgs(argc, argv, &repeats);
+    if (!first) return 1;
+    CharScanIsa const defaultIsa = charScanIsa();
+    CharScanIsa const isas[] = { CHAR_SCAN_SCALAR, CHAR_SCAN_SSE2, CHAR_SCAN_AVX2 };
+    for(int i = first; i < argc; ++i) {
+        std::ifstream ifs;
+        if (!openBenchFile(argv[i], ifs)) return 1;
+        std::streamoff const size = ifs.seekg(0, std::ios::end).tellg();
+
+        double best = 0;
+        size_t lines = 0;
+        for(unsigned j = 0; j < sizeof isas / sizeof isas[0]; ++j) {
+            if (!setCharScanIsa(isas[j])) continue;
+            bool const ok = bestParseTime(ifs, false, repeats, best, lines);
+            setCharScanIsa(defaultIsa);
+            if (!ok) return 1;
+            printf("%s %s%s: %zu lines, %.1f MB/s\n", argv[i], charScanIsaName(isas[j]),
+                isas[j] == defaultIsa ? " (default)" : "", lines, size / best / 1e6);
+        }
+        if (!bestParseTime(ifs, true, repeats, best, lines)) return 1;
+        printf("%s pipelined %s: %zu lines, %.1f MB/s\n", argv[i], charScanIsaName(defaultIsa),
+            lines, size / best / 1e6);
+    }
+    return 0;
+}
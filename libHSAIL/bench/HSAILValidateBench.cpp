@@ -0,0 +1,106 @@
+// University of Illinois/NCSA
+// Open Source License
+//
+// Copyright (c) 2013-2015, Advanced Micro Devices, Inc.
+// All rights reserved.
+//
+// Developed by:
+//
+//     HSA Team
+//
+//     Advanced Micro Devices, Inc
+//
+//     www.amd.com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the "Software"), to deal with
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+//     * Redistributions of source code must retain the above copyright notice,
+//       this list of conditions and the following disclaimers.
+//
+//     * Redistributions in binary form must reproduce the above copyright notice,
+//       this list of conditions and the following disclaimers in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the names of the LLVM Team, University of Illinois at
+//       Urbana-Champaign, nor the names of its contributors may be used to
+//       endorse or promote products derived from this Software without specific
+//       prior written permission.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS WITH THE
+// SOFTWARE.
+
+// Measures validator throughput in bytes of BRIG (all sections) per second,
+// with the fused single traversal of each section and with the checks run
+// one kind at a time, of the fused traversal at the lower validation
+// levels, and with all the executables found in the validation cache.
+// Usage: hsail-validate-bench [-n repeats] file.hsail...
+
+#include "BenchCommon.h"
+#include "HSAILValidator.h"
+#include "HSAILValidationCache.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+
+using namespace HSAIL_ASM;
+
+static double validateTime(BrigContainer& c, bool fused, int repeats, ValidationLevel level = VALIDATION_FULL,
+                           ValidationCache* cache = NULL)
+{
+    double best = 0;
+    for(int i = 0; i < repeats; ++i) {
+        Validator v(c);
+        v.setFusedTraversal(fused);
+        v.setLevel(level);
+        v.setCache(cache);
+        std::chrono::steady_clock::time_point const start = std::chrono::steady_clock::now();
+        bool const valid = v.validate();
+        double const t = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (!valid) {
+            std::cerr << v.getErrorMsg(NULL) << std::endl;
+            exit(1);
+        }
+        if (i == 0 || t < best) best = t;
+    }
+    return best;
+}
+
+int main(int argc, char** argv)
+{
+    int repeats;
+    int const first = parseBenchArgs(argc, argv, &repeats);
+    if (!first) return 1;
+    for(int i = first; i < argc; ++i) {
+        BrigContainer c;
+        if (!assembleBenchFile(argv[i], c)) return 1;
+
+        size_t bytes = 0;
+        for(int section = 0; section < c.getNumSections(); ++section) {
+            bytes += c.sectionById(section).size();
+        }
+        double const separate = validateTime(c, false, repeats);
+        double const fused = validateTime(c, true, repeats);
+        double const defUse = validateTime(c, true, repeats, VALIDATION_DEF_USE);
+        double const structure = validateTime(c, true, repeats, VALIDATION_STRUCTURE);
+        ValidationCache cache;
+        validateTime(c, true, 1, VALIDATION_FULL, &cache);
+        double const cached = validateTime(c, true, repeats, VALIDATION_FULL, &cache);
+        printf("%s: %zu bytes, separate %.1f MB/s, fused %.1f MB/s, %.2fx\n", argv[i], bytes,
+            bytes / separate / 1e6, bytes / fused / 1e6, separate / fused);
+        printf("%s: def/use %.1f MB/s, structure %.1f MB/s, cached %.1f MB/s (%zu executables), %.2fx\n", argv[i],
+            bytes / defUse / 1e6, bytes / structure / 1e6, bytes / cached / 1e6, cache.size(), fused / cached);
+    }
+    return 0;
+}
@@ -734,6 +734,12 @@ sub isOperandProp
     return isProp($prop) && $hdlPropType{getBaseProp($prop)} && $hdlPropType{getBaseProp($prop)} =~ /^operand/ && getOperandIdx($prop) == $idx;
 }
 
+sub hasValueSet    # Validator checks values of brig and operand properties using generated BrigValueSet tables
+{
+    my $prop = shift;
+    return $genValidator && (isBrigProp($prop) || ($hdlPropType{getBaseProp($prop)} && $hdlPropType{getBaseProp($prop)} =~ /^operand/));
+}
+
 sub needCustomCheck
 {
     my $prop = shift;
@@ -1206,6 +1212,7 @@ sub getTargetAttrName             { my ($prop, $val) = @_; return uc(getBaseProp
 sub getTargetValListName          { my ($prop, $val) = @_; return uc(getBaseProp($prop) . '_VALUES_' . $val); }
 sub getTargetReqName              { my $name = shift;      return 'req_' . $name; }
 sub getTargetBrigChkName          { my $name = shift;      return 'check_' . lc($name); }
+sub getTargetValueSetName         { my $name = shift;      return $name . '_SET'; }
 sub getTargetExChkName            { my $name = shift;      return 'validate' . ucfirst($name); }
 sub getTargetChkReqPropName       { my $name = shift;      return 'chkReqProp' . ucfirst(getInstReq($name)); }
 sub getTargetReqValidatorName     { my $name = shift;      return 'validateReq' . ucfirst(getInstReq($name)); }
@@ -2123,7 +2130,8 @@ sub translateVal
         isAlias($prop, $val) or lexError "Internal error: unknown array '$val' of property '$name'";
 
         my $array = getTargetArrayName($prop, $val);          # optimized list - replaced
-        return ($array, "sizeof($array) / sizeof(unsigned)"); # with array ref
+        my @set = (hasValueSet($prop) && !isBrigProp($prop))? (getTargetValueSetName($array)) : ();
+        return (@set, $array, "sizeof($array) / sizeof(unsigned)"); # with array ref
     }
 
     return getTargetValName($prop, $val);
@@ -2150,6 +2158,7 @@ sub genDirectCheck
     my ($prop, $name) = @_;
     my $targetName = getTargetArrayName($prop, $name);
     my $val = getTargetPropAccessorName($prop) . '<T>(inst)';
+    return getTargetValueSetName($targetName) . ".contains($val)" if $genValidator;
     return getTargetBrigChkName($targetName) . "($val)";
 }
 
@@ -2289,15 +2298,24 @@ sub genArrayDef
 sub genCheckDecl
 {
     my ($prop, $name) = getAliasComponents(shift);
+    my $targetName = getTargetArrayName($prop, $name);
+    if (hasValueSet($prop)) {
+        my $values = join(', ', translateValues($prop, getTargetArrayValues($prop, $name)));
+        print '    static constexpr BrigValueSet ', getTargetValueSetName($targetName), " = makeBrigValueSet($values);\n";
+        return;
+    }
     return if !isBrigProp($prop);
 
-    my $targetName = getTargetArrayName($prop, $name);
     print '    static bool ', getTargetBrigChkName($targetName), "(unsigned val);\n";
 }
 
 sub genCheckDef
 {
     my ($prop, $name) = getAliasComponents(shift);
+    if (hasValueSet($prop)) {
+        print "constexpr BrigValueSet ${className}::", getTargetValueSetName(getTargetArrayName($prop, $name)), ";\n";
+        return;
+    }
     return if !isBrigProp($prop);
 
     my $targetChkName = getTargetBrigChkName(getTargetArrayName($prop, $name));
@@ -2353,6 +2371,7 @@ sub genCommonDefinitions        # Generate definitions used by both Validator an
         setContext "generating check definition for '$alias'";
         genCheckDef($alias) if isArrayName($alias)
     }
+    print "\n" if $genValidator;
 }
 
 ###############################################################################
@@ -0,0 +1,373 @@
+// University of Illinois/NCSA
+// Open Source License
+//
+// Copyright (c) 2013-2015, Advanced Micro Devices, Inc.
+// All rights reserved.
+//
+// Developed by:
+//
+//     HSA Team
+//
+//     Advanced Micro Devices, Inc
+//
+//     www.amd.com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the "Software"), to deal with
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+//     * Redistributions of source code must retain the above copyright notice,
+//       this list of conditions and the following disclaimers.
+//
+//     * Redistributions in binary form must reproduce the above copyright notice,
+//       this list of conditions and the following disclaimers in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the names of the LLVM Team, University of Illinois at
+//       Urbana-Champaign, nor the names of its contributors may be used to
+//       endorse or promote products derived from this Software without specific
+//       prior written permission.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS WITH THE
+// SOFTWARE.
+#include "HSAILBrigBuilder.h"
+#include "HSAILItems.h"
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace HSAIL_ASM
+{
+
+namespace {
+
+// dedup key of an operand: a tag followed by the fields which identify it
+class OperandKey {
+    char     m_data[32];
+    unsigned m_size;
+public:
+    explicit OperandKey(char tag) : m_size(0) { m_data[m_size++] = tag; }
+
+    template <typename T> OperandKey& operator<<(T v) {
+        assert(m_size + sizeof(T) <= sizeof(m_data));
+        memcpy(m_data + m_size, &v, sizeof(T));
+        m_size += sizeof(T);
+        return *this;
+    }
+    OperandKey& append(const void* bytes, unsigned numBytes) {
+        assert(m_size + numBytes <= sizeof(m_data));
+        memcpy(m_data + m_size, bytes, numBytes);
+        m_size += numBytes;
+        return *this;
+    }
+    SRef ref() const { return SRef(m_data, m_data + m_size); }
+};
+
+std::string notFound(const char* what, const char* name) {
+    return std::string(what) + ": " + (name ? name : "");
+}
+
+}
+
+void BrigBuilder::addInsts(const BrigInstDesc* insts, size_t num)
+{
+    for(size_t i = 0; i < num; ++i) {
+        addInst(insts[i]);
+    }
+}
+
+Inst BrigBuilder::addInst(const BrigInstDesc& desc)
+{
+    if (desc.label) {
+        m_bw.addLabel(SRef(desc.label));
+    }
+    ItemList operands;
+    for(uint32_t i = 0; i < desc.numOperands; ++i) {
+        Operand const opnd = createOperand(desc.operands[i]);
+        if (!opnd) {
+            error("missing operand");
+        }
+        operands.push_back(opnd);
+    }
+    Inst const inst = appendInst(desc);
+    m_bw.setOperands(inst, operands);
+    return inst;
+}
+
+Inst BrigBuilder::appendInst(const BrigInstDesc& d)
+{
+    switch(d.kind) {
+    case BRIG_KIND_INST_ADDR: {
+        InstAddr inst = m_bw.addInst<InstAddr>(d.opcode, d.type);
+        inst.segment() = d.segment;
+        return inst;
+    }
+    case BRIG_KIND_INST_ATOMIC: {
+        InstAtomic inst = m_bw.addInst<InstAtomic>(d.opcode, d.type);
+        inst.segment() = d.segment;
+        inst.memoryOrder() = d.memoryOrder;
+        inst.memoryScope() = d.memoryScope;
+        inst.atomicOperation() = d.atomicOperation;
+        inst.equivClass() = d.equivClass;
+        return inst;
+    }
+    case BRIG_KIND_INST_BASIC:
+        return m_bw.addInst<InstBasic>(d.opcode, d.type);
+    case BRIG_KIND_INST_BR: {
+        InstBr inst = m_bw.addInst<InstBr>(d.opcode, d.type);
+        inst.width() = d.width;
+        return inst;
+    }
+    case BRIG_KIND_INST_CMP: {
+        InstCmp inst = m_bw.addInst<InstCmp>(d.opcode, d.type);
+        inst.sourceType() = d.sourceType;
+        inst.modifier().allBits() = d.modifier;
+        inst.compare() = d.compare;
+        inst.pack() = d.pack;
+        return inst;
+    }
+    case BRIG_KIND_INST_CVT: {
+        InstCvt inst = m_bw.addInst<InstCvt>(d.opcode, d.type);
+        inst.sourceType() = d.sourceType;
+        inst.modifier().allBits() = d.modifier;
+        inst.round() = d.round;
+        return inst;
+    }
+    case BRIG_KIND_INST_IMAGE: {
+        InstImage inst = m_bw.addInst<InstImage>(d.opcode, d.type);
+        inst.imageType() = d.sourceType;
+        inst.coordType() = d.coordType;
+        inst.geometry() = d.geometry;
+        inst.equivClass() = d.equivClass;
+        return inst;
+    }
+    case BRIG_KIND_INST_LANE: {
+        InstLane inst = m_bw.addInst<InstLane>(d.opcode, d.type);
+        inst.sourceType() = d.sourceType;
+        inst.width() = d.width;
+        return inst;
+    }
+    case BRIG_KIND_INST_MEM: {
+        InstMem inst = m_bw.addInst<InstMem>(d.opcode, d.type);
+        inst.segment() = d.segment;
+        inst.align() = d.align;
+        inst.equivClass() = d.equivClass;
+        inst.width() = d.width;
+        inst.modifier().allBits() = d.modifier;
+        return inst;
+    }
+    case BRIG_KIND_INST_MEM_FENCE: {
+        InstMemFence inst = m_bw.addInst<InstMemFence>(d.opcode, d.type);
+        inst.memoryOrder() = d.memoryOrder;
+        inst.globalSegmentMemoryScope() = d.memoryScope;
+        inst.groupSegmentMemoryScope() = d.groupSegmentMemoryScope;
+        inst.imageSegmentMemoryScope() = d.imageSegmentMemoryScope;
+        return inst;
+    }
+    case BRIG_KIND_INST_MOD: {
+        InstMod inst = m_bw.addInst<InstMod>(d.opcode, d.type);
+        inst.modifier().allBits() = d.modifier;
+        inst.round() = d.round;
+        inst.pack() = d.pack;
+        return inst;
+    }
+    case BRIG_KIND_INST_QUERY_IMAGE: {
+        InstQueryImage inst = m_bw.addInst<InstQueryImage>(d.opcode, d.type);
+        inst.imageType() = d.sourceType;
+        inst.geometry() = d.geometry;
+        inst.imageQuery() = d.query;
+        return inst;
+    }
+    case BRIG_KIND_INST_QUERY_SAMPLER: {
+        InstQuerySampler inst = m_bw.addInst<InstQuerySampler>(d.opcode, d.type);
+        inst.samplerQuery() = d.query;
+        return inst;
+    }
+    case BRIG_KIND_INST_QUEUE: {
+        InstQueue inst = m_bw.addInst<InstQueue>(d.opcode, d.type);
+        inst.segment() = d.segment;
+        inst.memoryOrder() = d.memoryOrder;
+        return inst;
+    }
+    case BRIG_KIND_INST_SEG: {
+        InstSeg inst = m_bw.addInst<InstSeg>(d.opcode, d.type);
+        inst.segment() = d.segment;
+        return inst;
+    }
+    case BRIG_KIND_INST_SEG_CVT: {
+        InstSegCvt inst = m_bw.addInst<InstSegCvt>(d.opcode, d.type);
+        inst.sourceType() = d.sourceType;
+        inst.segment() = d.segment;
+        inst.modifier().allBits() = d.modifier;
+        return inst;
+    }
+    case BRIG_KIND_INST_SIGNAL: {
+        InstSignal inst = m_bw.addInst<InstSignal>(d.opcode, d.type);
+        inst.signalType() = d.sourceType;
+        inst.memoryOrder() = d.memoryOrder;
+        inst.signalOperation() = d.atomicOperation;
+        return inst;
+    }
+    case BRIG_KIND_INST_SOURCE_TYPE: {
+        InstSourceType inst = m_bw.addInst<InstSourceType>(d.opcode, d.type);
+        inst.sourceType() = d.sourceType;
+        return inst;
+    }
+    default:
+        error("invalid instruction kind");
+        return Inst();
+    }
+}
+
+Operand BrigBuilder::find(const SRef& key)
+{
+    const uint32_t* const offset = m_operands.find(key);
+    return offset ? Operand(&m_bw.container(), *offset) : Operand();
+}
+
+Operand BrigBuilder::remember(const SRef& key, Operand operand)
+{
+    bool added;
+    m_operands.insert(key, operand.brigOffset(), added);
+    return operand;
+}
+
+Operand BrigBuilder::createOperand(const BrigOperandDesc& d)
+{
+    switch(d.kind) {
+    case OPERAND_NONE:
+        return Operand();
+
+    case OPERAND_REGISTER: {
+        OperandKey key('R');
+        key << d.regKind << d.regNum;
+        if (Operand const opnd = find(key.ref())) return opnd;
+        OperandRegister reg = m_bw.append<OperandRegister>();
+        reg.regKind() = d.regKind;
+        reg.regNum() = d.regNum;
+        return remember(key.ref(), reg);
+    }
+
+    case OPERAND_IMMED: {
+        unsigned const numBytes = getBrigTypeNumBytes(d.type);
+        const void* const bytes = d.bytes ? d.bytes : &d.value;
+        if (d.bytes==NULL && numBytes > sizeof(d.value)) {
+            error("immediate value doesn't fit 64 bits");
+        }
+        OperandKey key('I');
+        key << d.type;
+        key.append(bytes, numBytes);
+        if (Operand const opnd = find(key.ref())) return opnd;
+        const char* const data = (const char*)bytes;
+        return remember(key.ref(), m_bw.createImmed(SRef(data, data + numBytes), d.type));
+    }
+
+    case OPERAND_ADDRESS: {
+        DirectiveVariable var;
+        if (d.name) {
+            var = m_bw.findInScopes<DirectiveVariable>(SRef(d.name));
+            if (!var) error(notFound("Symbol not found", d.name).c_str());
+        }
+        OperandRegister reg;
+        if (d.numElements > 0) {
+            if (d.elements[0].kind!=OPERAND_REGISTER) error("address base must be a register");
+            reg = createOperand(d.elements[0]);
+        }
+        OperandKey key('A');
+        key << var.brigOffset() << reg.brigOffset() << d.value;
+        if (Operand const opnd = find(key.ref())) return opnd;
+        return remember(key.ref(), m_bw.createRef(var, reg, (int64_t)d.value));
+    }
+
+    case OPERAND_LABEL: {
+        if (!d.name) error("label expected");
+        // labels are local to a body, so are the operands referring to them
+        Offset const body = m_bw.currentExecutable().brigOffset();
+        if (body != m_labelBody) {
+            m_labelOperands.clear();
+            m_labelBody = body;
+        }
+        SRef const name(d.name);
+        bool added;
+        uint32_t* const offset = m_labelOperands.insert(name, 0, added);
+        if (!added) return Operand(&m_bw.container(), *offset);
+        Operand const opnd = m_bw.createLabelRef(name);
+        *offset = opnd.brigOffset();
+        return opnd;
+    }
+
+    case OPERAND_CODE_REF: {
+        Directive const dir = d.name ? m_bw.findInScopes<Directive>(SRef(d.name)) : Directive();
+        if (!dir) error(notFound("identifier not found", d.name).c_str());
+        OperandKey key('C');
+        key << dir.brigOffset();
+        if (Operand const opnd = find(key.ref())) return opnd;
+        return remember(key.ref(), m_bw.createCodeRef(dir));
+    }
+
+    case OPERAND_CODE_LIST:
+        return createCodeList(d);
+
+    case OPERAND_OPERAND_LIST:
+        return createOperandList(d);
+
+    case OPERAND_WAVESIZE: {
+        OperandKey key('W');
+        if (Operand const opnd = find(key.ref())) return opnd;
+        return remember(key.ref(), m_bw.createWaveSz());
+    }
+
+    default:
+        error("invalid operand kind");
+        return Operand();
+    }
+}
+
+Operand BrigBuilder::createCodeList(const BrigOperandDesc& d)
+{
+    if (d.numElements > 0 && d.elements[0].kind==OPERAND_LABEL) {
+        std::vector<SRef> labels;
+        for(uint32_t i = 0; i < d.numElements; ++i) {
+            if (d.elements[i].kind!=OPERAND_LABEL || !d.elements[i].name) error("label expected");
+            labels.push_back(SRef(d.elements[i].name));
+        }
+        return m_bw.createLabelList(labels);
+    }
+
+    ItemList list;
+    for(uint32_t i = 0; i < d.numElements; ++i) {
+        const BrigOperandDesc& e = d.elements[i];
+        Directive const dir = e.kind==OPERAND_CODE_REF && e.name ? m_bw.findInScopes<Directive>(SRef(e.name)) : Directive();
+        if (!dir) error(notFound("identifier not found", e.name).c_str());
+        list.push_back(dir);
+    }
+    std::string key(1, 'L');
+    key.append(list.data().begin, list.data().end);
+    if (Operand const opnd = find(SRef(key))) return opnd;
+    return remember(SRef(key), m_bw.createCodeList(list));
+}
+
+Operand BrigBuilder::createOperandList(const BrigOperandDesc& d)
+{
+    ItemList list;
+    for(uint32_t i = 0; i < d.numElements; ++i) {
+        Operand const opnd = createOperand(d.elements[i]);
+        if (!opnd) error("missing operand");
+        list.push_back(opnd);
+    }
+    std::string key(1, 'O');
+    key.append(list.data().begin, list.data().end);
+    if (Operand const opnd = find(SRef(key))) return opnd;
+    return remember(SRef(key), m_bw.createOperandList(list));
+}
+
+}
@@ -0,0 +1,148 @@
+// University of Illinois/NCSA
+// Open Source License
+//
+// Copyright (c) 2013-2015, Advanced Micro Devices, Inc.
+// All rights reserved.
+//
+// Developed by:
+//
+//     HSA Team
+//
+//     Advanced Micro Devices, Inc
+//
+//     www.amd.com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the "Software"), to deal with
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+//     * Redistributions of source code must retain the above copyright notice,
+//       this list of conditions and the following disclaimers.
+//
+//     * Redistributions in binary form must reproduce the above copyright notice,
+//       this list of conditions and the following disclaimers in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the names of the LLVM Team, University of Illinois at
+//       Urbana-Champaign, nor the names of its contributors may be used to
+//       endorse or promote products derived from this Software without specific
+//       prior written permission.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS WITH THE
+// SOFTWARE.
+#pragma once
+#ifndef INCLUDED_HSAIL_BRIG_BUILDER_H
+#define INCLUDED_HSAIL_BRIG_BUILDER_H
+
+#include "HSAILBrigantine.h"
+
+namespace HSAIL_ASM
+{
+
+/// Descriptors of BrigBuilder. They are plain structures so that
+/// producers may fill arrays of them in bulk; brig_inst_desc and
+/// brig_operand_desc of the C API have the same layout.
+
+/// operand of an instruction. Which fields are used depends on the kind.
+struct BrigOperandDesc {
+    uint32_t kind;        // BrigBuilder::OperandKind
+    uint32_t type;        // IMMED: BrigType of the value
+    uint32_t regKind;     // REGISTER: BrigRegisterKind
+    uint32_t regNum;      // REGISTER: register number
+    uint64_t value;       // IMMED: the value if it fits 64 bits; ADDRESS: offset
+    const void* bytes;    // IMMED: the value of wider types, NULL otherwise
+    const char* name;     // ADDRESS: symbol or NULL; LABEL: label; CODE_REF: any directive
+    const BrigOperandDesc* elements; // ADDRESS: base register or NULL; lists: elements
+    uint32_t numElements;
+};
+
+/// instruction. Fields not present in the instruction format are ignored;
+/// some fields are shared by formats as noted.
+struct BrigInstDesc {
+    uint16_t kind;        // BrigKind of the instruction format
+    uint16_t opcode;
+    uint16_t type;
+    uint16_t sourceType;  // also imageType of IMAGE/QUERY_IMAGE, signalType of SIGNAL
+    uint16_t coordType;
+    uint8_t  segment;
+    uint8_t  align;
+    uint8_t  width;
+    uint8_t  equivClass;
+    uint8_t  modifier;    // raw bits of AluModifier, MemoryModifier or SegCvtModifier
+    uint8_t  round;
+    uint8_t  pack;
+    uint8_t  compare;
+    uint8_t  memoryOrder;
+    uint8_t  memoryScope; // also globalSegmentMemoryScope of MEM_FENCE
+    uint8_t  groupSegmentMemoryScope;
+    uint8_t  imageSegmentMemoryScope;
+    uint8_t  atomicOperation; // also signalOperation of SIGNAL
+    uint8_t  geometry;
+    uint8_t  query;       // imageQuery or samplerQuery
+    const char* label;    // label defined at the instruction or NULL
+    const BrigOperandDesc* operands;
+    uint32_t numOperands;
+};
+
+/// emits instructions described by BrigInstDesc through a Brigantine
+/// without going through HSAIL text. Operands are shared between
+/// instructions: each distinct register, immediate, address, directive
+/// reference or list is written once. Directives are emitted with the
+/// Brigantine directly.
+class BrigBuilder
+{
+public:
+    enum OperandKind {
+        OPERAND_NONE = 0,
+        OPERAND_REGISTER,
+        OPERAND_IMMED,
+        OPERAND_ADDRESS,
+        OPERAND_LABEL,
+        OPERAND_CODE_REF,
+        OPERAND_CODE_LIST,    // elements are all CODE_REF or all LABEL
+        OPERAND_OPERAND_LIST,
+        OPERAND_WAVESIZE
+    };
+
+    BrigBuilder(Brigantine& bw) : m_bw(bw), m_labelBody(0) {}
+
+    Brigantine& brigantine() const { return m_bw; }
+
+    /// emit a batch of instructions (and labels) to the current body.
+    /// Throws SyntaxError on invalid descriptors, as does the Brigantine.
+    void addInsts(const BrigInstDesc* insts, size_t num);
+
+    /// emit a single instruction, see addInsts.
+    Inst addInst(const BrigInstDesc& desc);
+
+    /// emit the operand or return the same one emitted before.
+    Operand createOperand(const BrigOperandDesc& desc);
+
+private:
+    Brigantine& m_bw;
+    NameMap     m_operands;      // key -> operand offset
+    NameMap     m_labelOperands; // label name -> operand offset, for one body
+    Offset      m_labelBody;     // executable m_labelOperands belong to
+
+    Inst    appendInst(const BrigInstDesc& desc);
+    Operand createCodeList(const BrigOperandDesc& desc);
+    Operand createOperandList(const BrigOperandDesc& desc);
+    Operand find(const SRef& key);
+    Operand remember(const SRef& key, Operand operand);
+
+    void error(const char* msg) const { throw SyntaxError(msg); }
+
+    BrigBuilder& operator=(const BrigBuilder&);
+};
+
+}
+
+#endif
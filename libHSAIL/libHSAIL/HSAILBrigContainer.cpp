@@ -218,6 +218,25 @@ Offset DataSection::addString(const SRef& newStr)
     return res;
 }
 
+Offset DataSection::findString(const SRef& str) const
+{
+    std::vector<Offset>::const_iterator const i = std::lower_bound(
+        m_stringSet.begin(),m_stringSet.end(),
+        str,StringRefComparer(const_cast<DataSection*>(this)));
+    return i!=m_stringSet.end() && getString(*i)==str ? *i : 0;
+}
+
+void DataSection::truncate(Offset newSize)
+{
+    assert(newSize <= size());
+    std::vector<Offset>::iterator kept = m_stringSet.begin();
+    for(std::vector<Offset>::const_iterator i = m_stringSet.begin(); i != m_stringSet.end(); ++i) {
+        if (*i < newSize) *kept++ = *i;
+    }
+    m_stringSet.erase(kept,m_stringSet.end());
+    deleteData(newSize,size() - newSize);
+}
+
 Offset DataSection::addStringImpl(const SRef& newStr)
 {
     size_t const allocSize = align(newStr.length(),ITEM_ALIGNMENT);
@@ -363,7 +382,11 @@ class MakeDecl2DefMap
         }
     }
     void resetModuleScope() {
-        m_moduleScope.reset(new Scope(m_overallScope.container()));
+        if (m_moduleScope.get()!=NULL) {
+            m_moduleScope->clear();
+        } else {
+            m_moduleScope.reset(new Scope(m_overallScope.container()));
+        }
     }
 
 public:
@@ -447,6 +470,7 @@ void BrigContainer::setContents(std::vector<char>& buf) {
     m_brigModuleBuffer.swap(buf);
     m_sections.swap(secs);
     m_brigModuleHeader = hdr;
+    m_itemIndex.clear();
 }
 
 void BrigContainer::setData(const void *data, size_t size)
@@ -457,6 +481,14 @@ void BrigContainer::setData(const void *data, size_t size)
   m_brigModuleHeader = (const BrigModuleHeader*) &m_brigModuleBuffer[0];
   m_sections.clear();
   initSections(*m_brigModuleHeader, m_sections);
+  m_itemIndex.clear();
+}
+
+void BrigContainer::setStructurallyVerified(std::vector< std::vector<Offset> >& itemIndex)
+{
+    assert(isROContainer());
+    assert(itemIndex.size() == BRIG_SECTION_INDEX_IMPLEMENTATION_DEFINED);
+    m_itemIndex.swap(itemIndex);
 }
 
 static bool writeSection(WriteAdapter& w,
@@ -521,9 +553,12 @@ bool BrigContainer::write(WriteAdapter& w) const {
     std::vector<uint64_t> sectionIndex;
     sectionIndex.resize(hdr.sectionCount);
 
+    // all offsets are computed by the dry run, so the actual output is
+    // written strictly sequentially and w is never queried for position
     NullWriteAdapter nullWA(w.errs);
+    SequentialWriteAdapter seqWA(w);
     return writeContents(nullWA, *this, hdr, &sectionIndex[0]) &&
-           writeContents(w, *this, hdr, &sectionIndex[0]);
+           writeContents(seqWA, *this, hdr, &sectionIndex[0]);
 }
 
 static bool readSection(ReadAdapter& r,
@@ -538,9 +573,7 @@ static bool readSection(ReadAdapter& r,
     }
 
     std::vector<char> secData;
-    secData.resize((Offset)hdr.byteCount);
-
-    if (r.pread((char*)&secData[0], (Offset)hdr.byteCount, startPos)) {
+    if (r.readInto(secData, (Offset)hdr.byteCount, startPos)) {
         r.errs << "cannot read section data at " << index << " index" << std::endl;
         return false;
     }
@@ -562,9 +595,12 @@ bool readContainer(ReadAdapter& r, BrigContainer& c, bool writeable) {
 
     if (!writeable) {
         std::vector<char> buf;
-        buf.resize((size_t)hdr.byteCount);
-        if (r.pread(&buf[0], (size_t)hdr.byteCount, 0)) {
-            r.errs << "cannot read Brig" << std::endl;
+        // adapters buffering the whole module give it away without copying
+        if (r.getSize() != hdr.byteCount || !r.releaseContents(buf)) {
+            if (r.readInto(buf, (size_t)hdr.byteCount, 0)) {
+                r.errs << "cannot read Brig" << std::endl;
+                return false;
+            }
         }
         c.setContents(buf);
     } else {
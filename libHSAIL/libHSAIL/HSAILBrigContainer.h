@@ -252,6 +252,40 @@ public:
         syncWithBuffer();
     }
 
+    /// replaces data in [begin,end) with the data from 'from' to the end of
+    /// the section, which is removed from there. Source info moves along with
+    /// the data, offsets stored in the items are not patched.
+    /// @param begin, end - range to replace.
+    /// @param from - start of the tail data, not less than end.
+    void spliceTail(Offset begin, Offset end, Offset from) {
+        assert(hasOwnBuffer());
+        assert(begin <= end && end <= from && from <= m_buffer.size());
+        Buffer const tail(m_buffer.begin() + from, m_buffer.end());
+        m_buffer.resize(from);
+        m_buffer.erase(m_buffer.begin() + begin, m_buffer.begin() + end);
+        m_buffer.insert(m_buffer.begin() + begin, tail.begin(), tail.end());
+        syncWithBuffer();
+
+        Offset const tailSize = (Offset)tail.size();
+        SectionSourceInfo si;
+        si.reserve(m_sourceInfo.size());
+        SectionSourceInfo::const_iterator i = m_sourceInfo.begin(), e = m_sourceInfo.end();
+        for(; i != e && i->first < begin; ++i) {
+            si.push_back(*i);
+        }
+        SectionSourceInfo::const_iterator const rest = i;
+        for(; i != e && i->first < from; ++i) {}
+        for(; i != e; ++i) {
+            si.push_back(std::make_pair(i->first - from + begin, i->second));
+        }
+        for(i = rest; i != e && i->first < from; ++i) {
+            if (i->first >= end) {
+                si.push_back(std::make_pair(i->first - end + begin + tailSize, i->second));
+            }
+        }
+        m_sourceInfo.swap(si);
+    }
+
     /// size of the section in bytes.
     Offset size() const { return (Offset)secHeader()->byteCount; }
 
@@ -438,6 +472,13 @@ public:
     // add without deduplication
     Offset addStringImpl(const SRef& newStr);
 
+    // offset of a string previously added by addString, 0 if there is none
+    Offset findString(const SRef& str) const;
+
+    // removes the strings added at or after newSize, newSize must be a
+    // former size of the section
+    void truncate(Offset newSize);
+
     SRef getString(Offset offset) const {
         assert(offset);
         const BrigData* s = getData<const BrigData>(offset);
@@ -495,6 +536,10 @@ private:
     const BrigModuleHeader* m_brigModuleHeader;
     std::vector<char> m_brigModuleBuffer;
 
+    // item offsets collected by BrigIO::loadVerified, one sorted vector
+    // per standard section; empty unless the container passed that check
+    std::vector< std::vector<Offset> > m_itemIndex;
+
     void initSections(const BrigModuleHeader& brigModule,
                       BrigContainer::SectionVector& secs);
 
@@ -505,6 +550,21 @@ public:
     bool isRWContainer() const { return !isROContainer(); }
     bool hasOwnBuffer() const { return !m_brigModuleBuffer.empty(); }
 
+    /// true if the module structure and the item layout of the standard
+    /// sections were checked on load (see BrigIO::loadVerified)
+    bool isStructurallyVerified() const { return !m_itemIndex.empty(); }
+
+    /// sorted offsets of all items of a standard section.
+    /// Only available for structurally verified containers.
+    const std::vector<Offset>& itemIndex(int section) const {
+        assert(isStructurallyVerified());
+        return m_itemIndex[section];
+    }
+
+    /// mark read-only container as structurally verified,
+    /// itemIndex contents are taken over
+    void setStructurallyVerified(std::vector< std::vector<Offset> >& itemIndex);
+
     BrigContainer(); // RW container
 
     BrigContainer(const BrigModuleHeader* brigModule); // RO container
@@ -40,14 +40,19 @@
 // SOFTWARE.
 #include "HSAILBrigObjectFile.h"
 #include "HSAILBrigContainer.h"
+#include "HSAILItems.h"
+#include "HSAILSymbolIndex.h"
 
 #include <errno.h>
 #ifdef _WIN32
 #include <io.h>
+#include <stdio.h>
 #define O_BINARY_ O_BINARY
 #define LSEEK _lseeki64
 #else
 #include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #define O_BINARY_ 0
 #define LSEEK lseek64
 #endif
@@ -270,6 +275,16 @@ int WriteAdapter::writeAlignPad(unsigned pow2) {
 ReadAdapter::~ReadAdapter() {
 }
 
+int ReadAdapter::readInto(std::vector<char>& dst, size_t numBytes, uint64_t ofs) const {
+    if (const char* p = view(ofs, numBytes)) {
+        dst.assign(p, p + numBytes);
+        return 0;
+    }
+    dst.resize(numBytes);
+    if (0 == numBytes) return 0;
+    return pread(&dst[0], numBytes, ofs);
+}
+
 ReadWriteAdapter::~ReadWriteAdapter() {
 }
 
@@ -299,7 +314,7 @@ public:
 
     // Loading code
 public:
-    int readContainer(BrigContainer &c, ReadAdapter *s) {
+    int readContainer(BrigContainer &c, ReadAdapter *s, bool verify = false) {
         if (s->pread((char*)&elfHeader, sizeof(elfHeader), 0)) {
             return 1;
         }
@@ -335,6 +350,10 @@ public:
 
             if (desc->sectionId == BRIG_SECTION_INDEX_BLOB) {
                 const Shdr &h = sectionHeaders[i];
+                if (verify) {
+                    return BrigIO::loadVerified(c, FILE_FORMAT_BRIG,
+                        *BrigIO::fragmentReadingAdapter(s, h.sh_size, h.sh_offset));
+                }
                 if (!HSAIL_ASM::readContainer(
                     *BrigIO::fragmentReadingAdapter(s, h.sh_size,
                                                        h.sh_offset), c)) {
@@ -357,9 +376,7 @@ public:
 private:
 
     int preadVec(ReadAdapter *s, std::vector<char> &dst, unsigned size, uint64_t ofs) const {
-        dst.resize(size);
-        if (0 == size) return 0;
-        return s->pread(&(dst[0]), size, ofs);
+        return s->readInto(dst, size, ofs);
     };
 
     const char* sectionName(unsigned index) {
@@ -659,10 +676,12 @@ struct FileAdapter : public ReadWriteAdapter {
 #else
 struct FileAdapter : public ReadWriteAdapter {
     mutable FILE* fd;
+    bool          ownsFile;
     FileAdapter(std::ostream& errs_)
         : IOAdapter(errs_)
         , ReadWriteAdapter(errs_)
         , fd(nullptr)
+        , ownsFile(true)
     {
     }
     static void printErr(std::ostream& s) {
@@ -677,6 +696,19 @@ struct FileAdapter : public ReadWriteAdapter {
         }
         return 0;
     }
+    // attach to an already open stream which is not closed on destruction
+    int attach(FILE* f) {
+#ifdef _WIN32
+        if (_setmode(_fileno(f), _O_BINARY) == -1) {
+            printErr(errs);
+            errs << " switching output to binary mode" << std::endl;
+            return 1;
+        }
+#endif
+        fd = f;
+        ownsFile = false;
+        return 0;
+    }
     int check1(int val) const {
         if (val < 0) {
             printErr(errs);
@@ -705,7 +737,7 @@ struct FileAdapter : public ReadWriteAdapter {
         return (Position)ftell(fd);
     }
     virtual void setPos(Position ofs) {
-        fseek(fd, 0, SEEK_SET);
+        fseek(fd, (long)ofs, SEEK_SET);
     }
     virtual int write(const char* data, size_t numBytes) const {
         size_t const res = fwrite(data, 1, numBytes, fd);
@@ -734,7 +766,11 @@ struct FileAdapter : public ReadWriteAdapter {
     }
     ~FileAdapter() {
         if (fd) {
-            fclose(fd);
+            if (ownsFile) {
+                fclose(fd);
+            } else {
+                fflush(fd);
+            }
         }
     }
 };
@@ -768,6 +804,11 @@ struct FragmentReadAdapter : ReadAdapter {
         return r.pread(data, numBytes, ofs + this->offset);
     }
 
+    virtual const char* view(uint64_t ofs, size_t numBytes) const {
+        if (ofs > size || numBytes > size - ofs) return 0;
+        return r.view(ofs + this->offset, numBytes);
+    }
+
     virtual Position getSize() const { return size; };
 };
 
@@ -808,6 +849,10 @@ struct VectorAdapter : public ReadWriteAdapter {
         memcpy(data, &buf[static_cast<size_t>(offset)], numBytes);
         return 0;
     }
+    virtual const char* view(uint64_t offset, size_t numBytes) const {
+        if (offset > buf.size() || numBytes > buf.size() - offset) return 0;
+        return buf.data() + offset;
+    }
     ~VectorAdapter() {
     }
 };
@@ -854,45 +899,107 @@ struct MemoryAdapter : public ReadWriteAdapter {
         memcpy(data, buf + offset, numBytes);
         return 0;
     }
+    virtual const char* view(uint64_t offset, size_t numBytes) const {
+        if (offset > bufSize || numBytes > bufSize - offset) return 0;
+        return buf + offset;
+    }
     ~MemoryAdapter() {
     }
 };
 
+// Reads the stream once, sequentially and in large chunks, into a growing
+// buffer and serves all requests from it. The only seeks are the ones to
+// learn the size of the stream in advance, so non-seekable streams (pipes,
+// sockets) work as well. Offsets are relative to the initial stream position.
 struct istreamAdapter : public ReadAdapter {
-    std::istream&   is;
+    std::istream&               is;
+    mutable std::vector<char>   buf;
+    mutable bool                eof;
+    Position                    pos;
+
+    enum { CHUNK_SIZE = 1024*1024 };
 
     istreamAdapter(std::istream& is_, std::ostream &errs_)
         : IOAdapter(errs_)
         , ReadAdapter(errs_)
         , is(is_)
-    {}
+        , eof(false)
+        , pos(0)
+    {
+        std::streampos const start = is.tellg();
+        if (start != std::streampos(-1)) {
+            is.seekg(0, std::ios_base::end);
+            std::streampos const end = is.tellg();
+            is.seekg(start);
+            if (!is.fail() && end != std::streampos(-1) && end >= start) {
+                buf.reserve(static_cast<size_t>(end - start));
+            }
+        }
+        if (is.fail() && !is.bad()) {
+            is.clear(); // not seekable, grow the buffer as we go
+        }
+    }
     ~istreamAdapter() {}
 
+    // reads until at least upTo bytes are buffered or the stream ends
+    bool fill(uint64_t upTo) const {
+        while (buf.size() < upTo && !eof) {
+            size_t const old = buf.size();
+            if (old == buf.capacity() && old > 0 &&
+                is.peek() == std::char_traits<char>::eof()) {
+                eof = true; // do not grow the buffer just to learn there is no more data
+                break;
+            }
+            size_t const chunk = (std::max)(static_cast<size_t>(CHUNK_SIZE), buf.capacity() - old);
+            buf.resize(old + chunk);
+            is.read(&buf[old], static_cast<std::streamsize>(chunk));
+            size_t const n = static_cast<size_t>(is.gcount());
+            buf.resize(old + n);
+            if (n < chunk) {
+                eof = true;
+                if (is.bad()) {
+                    errs << "Error reading stream" << std::endl;
+                }
+            }
+        }
+        return buf.size() >= upTo;
+    }
+
     virtual Position getPos() const {
-        return (Position)is.tellg();
+        return pos;
     }
 
     virtual void setPos(Position p) {
-        is.seekg(static_cast<std::streamoff>(p), std::ios_base::beg);
+        pos = p;
+    }
+
+    virtual Position getSize() const {
+        fill((std::numeric_limits<uint64_t>::max)());
+        return buf.size();
     }
 
     virtual int pread(char* data, size_t numBytes, uint64_t offset) const {
-        if ((offset + numBytes) > static_cast<uint64_t>((std::numeric_limits<std::streamoff>::max)())) {
-            errs << "Reading beyond the end of the buffer" << std::endl;
-            return 1;
-        }
-        is.seekg(static_cast<std::streamoff>(offset), std::ios_base::beg);
-        if (is.fail()) {
-            errs << "Stream seek error" << std::endl;
-            return 1;
-        }
-        is.read(data, static_cast<std::streamsize>(numBytes));
-        if (is.fail() || static_cast<size_t>(is.gcount()) < numBytes) {
-            errs << "Error reading stream" << std::endl;
+        const char* p = view(offset, numBytes);
+        if (!p) {
+            errs << "Reading beyond the end of the stream" << std::endl;
             return 1;
         }
+        if (numBytes == 0) return 0;
+        memcpy(data, p, numBytes);
         return 0;
     }
+
+    virtual const char* view(uint64_t offset, size_t numBytes) const {
+        if (offset + numBytes < offset || !fill(offset + numBytes)) return 0;
+        return buf.data() + offset;
+    }
+
+    virtual bool releaseContents(std::vector<char>& dst) {
+        fill((std::numeric_limits<uint64_t>::max)());
+        dst.swap(buf);
+        buf.clear();
+        return true;
+    }
 };
 
 // TBD this is the only non-forward dependency on iostream
@@ -922,6 +1029,16 @@ std::unique_ptr<WriteAdapter> BrigIO::fileWritingAdapter(
     return std::move(theFile);
 }
 
+std::unique_ptr<WriteAdapter> BrigIO::stdoutWritingAdapter(
+                std::ostream& errs)
+{
+    std::unique_ptr<FileAdapter> theFile( new FileAdapter(errs) );
+    if (theFile->attach(stdout)) {
+        theFile.release();
+    }
+    return std::move(theFile);
+}
+
 std::unique_ptr<WriteAdapter> BrigIO::memoryWritingAdapter(
                     char         *buf,
                     size_t        size,
@@ -963,6 +1080,130 @@ std::unique_ptr<ReadAdapter> BrigIO::fragmentReadingAdapter(
             new FragmentReadAdapter(*r, size, offset));
 }
 
+// SHARED MEMORY HANDOFF
+
+#ifndef _WIN32
+
+static int createSharedMemory(std::ostream& errs)
+{
+#if defined(__linux__) && defined(MFD_ALLOW_SEALING)
+    int fd = memfd_create("brig", MFD_ALLOW_SEALING);
+    if (fd >= 0) return fd;
+#endif
+    // anonymous POSIX shared memory object: unlinked right after creation
+    char name[64];
+    for(int attempt = 0; attempt < 16; ++attempt) {
+        snprintf(name, sizeof name, "/brig.%ld.%d", (long)getpid(), attempt);
+        int fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+        if (fd >= 0) {
+            shm_unlink(name);
+            return fd;
+        }
+        if (errno != EEXIST) break;
+    }
+    errs << "Failed to create shared memory object: " << strerror(errno) << std::endl;
+    return -1;
+}
+
+int BrigIO::exportToSharedMemory(const BrigContainer& src, std::ostream& errs)
+{
+    uint64_t size;
+    if (src.isROContainer()) {
+        size = src.getBrigModuleHeader()->byteCount;
+    } else {
+        NullWriteAdapter nwa(errs);
+        if (!src.write(nwa)) return -1;
+        size = nwa.getPos();
+    }
+
+    int const fd = createSharedMemory(errs);
+    if (fd < 0) return -1;
+    if (ftruncate(fd, (off_t)size) != 0) {
+        errs << "Failed to allocate shared memory: " << strerror(errno) << std::endl;
+        close(fd);
+        return -1;
+    }
+    void* const p = mmap(0, (size_t)size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (p == MAP_FAILED) {
+        errs << "Failed to map shared memory: " << strerror(errno) << std::endl;
+        close(fd);
+        return -1;
+    }
+
+    // RW containers are serialized right into the mapping
+    bool ok = true;
+    if (src.isROContainer()) {
+        memcpy(p, src.getBrigModuleHeader(), (size_t)size);
+    } else {
+        MemoryAdapter mem((char*)p, (size_t)size, errs);
+        ok = src.write(mem);
+    }
+    munmap(p, (size_t)size);
+    if (!ok) {
+        close(fd);
+        return -1;
+    }
+
+#if defined(__linux__) && defined(F_ADD_SEALS)
+    // receivers may rely on the module being immutable
+    fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE | F_SEAL_SEAL);
+#endif
+    return fd;
+}
+
+const BrigModuleHeader* BrigIO::mapSharedMemory(int fd, std::ostream& errs)
+{
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        errs << "Failed to query shared memory size: " << strerror(errno) << std::endl;
+        return 0;
+    }
+    uint64_t const size = (uint64_t)st.st_size;
+    if (size < sizeof(BrigModuleHeader) || size >= (std::numeric_limits<size_t>::max)()) {
+        errs << "Shared memory object does not contain BRIG module" << std::endl;
+        return 0;
+    }
+    void* const p = mmap(0, (size_t)size, PROT_READ, MAP_SHARED, fd, 0);
+    if (p == MAP_FAILED) {
+        errs << "Failed to map shared memory: " << strerror(errno) << std::endl;
+        return 0;
+    }
+    const BrigModuleHeader* const hdr = (const BrigModuleHeader*)p;
+    if (memcmp("HSA BRIG", hdr->identification, sizeof(hdr->identification)) != 0 ||
+        hdr->byteCount != size) {
+        errs << "Shared memory object does not contain BRIG module" << std::endl;
+        munmap(p, (size_t)size);
+        return 0;
+    }
+    return hdr;
+}
+
+void BrigIO::unmapSharedMemory(const BrigModuleHeader* module)
+{
+    if (module) {
+        munmap((void*)module, (size_t)module->byteCount);
+    }
+}
+
+#else
+
+int BrigIO::exportToSharedMemory(const BrigContainer& src, std::ostream& errs)
+{
+    errs << "Shared memory handoff is not supported on this platform" << std::endl;
+    return -1;
+}
+
+const BrigModuleHeader* BrigIO::mapSharedMemory(int fd, std::ostream& errs)
+{
+    errs << "Shared memory handoff is not supported on this platform" << std::endl;
+    return 0;
+}
+
+void BrigIO::unmapSharedMemory(const BrigModuleHeader* module)
+{
+}
+
+#endif
 
 int BrigIO::load(BrigContainer &dst,
                  int           fmt,
@@ -994,11 +1235,18 @@ int BrigIO::save(BrigContainer &src,
                  int           fmt,
                  WriteAdapter& dst)
 {
+    if (fmt & FILE_FORMAT_SYMBOL_INDEX) {
+        if (!src.isRWContainer()) {
+            dst.errs << "Symbol index can only be added to a writeable container" << std::endl;
+            return 1;
+        }
+        buildSymbolIndex(src);
+    }
     switch (fmt & FILE_FORMAT_MASK) {
     case FILE_FORMAT_BRIG:
         return src.write(dst) ? 0 : 1;
     case FILE_FORMAT_BIF:
-        switch (fmt & ~FILE_FORMAT_MASK) {
+        switch (fmt & FILE_FORMAT_ELF_MASK) {
         case FILE_FORMAT_ELF32: {
             BrigIOImpl<Elf32Policy> impl(fmt);
             return impl.writeContainer(&dst, src);
@@ -1027,17 +1275,9 @@ int BrigIO::save(BrigContainer &src,
 
 typedef map<uint64_t, uint64_t> ModuleMap;
 
-int BrigIO::validateBrigBlob(ReadAdapter&   fd)
+// checks of the module header which do not require reading anything else
+static int validateModuleHeader(ReadAdapter& fd, const BrigModuleHeader& moduleHdr, uint64_t fileSize)
 {
-    BrigModuleHeader moduleHdr;
-    ModuleMap map;
-
-    uint64_t fileSize = (uint64_t)fd.getSize();
-    VALIDATE(fileSize != (uint64_t)-1, "Filed to read file size");
-
-    VALIDATE(fileSize > sizeof(BrigModuleHeader), "File is too small for BRIG or ELF");
-    VALIDATE(fd.pread((char*)&moduleHdr, sizeof(BrigModuleHeader), 0) == 0, "Failed to read BrigModuleHeader");
-
     if (memcmp("HSA BRIG", moduleHdr.identification, sizeof(moduleHdr.identification)) != 0) {
         VALIDATE(false, "Unsupported file format");
     }
@@ -1055,6 +1295,24 @@ int BrigIO::validateBrigBlob(ReadAdapter&   fd)
     VALIDATE(moduleHdr.sectionIndex < fileSize,                     "Invalid BrigModuleHeader.sectionIndex: position of section index is outside of BRIG module");
     VALIDATE(secIdxSize <= fileSize - moduleHdr.sectionIndex,       "Invalid BrigModuleHeader.sectionIndex: section index does not fit into BRIG module");
 
+    return 0;
+}
+
+int BrigIO::validateBrigBlob(ReadAdapter&   fd)
+{
+    BrigModuleHeader moduleHdr;
+    ModuleMap map;
+
+    uint64_t fileSize = (uint64_t)fd.getSize();
+    VALIDATE(fileSize != (uint64_t)-1, "Filed to read file size");
+
+    VALIDATE(fileSize > sizeof(BrigModuleHeader), "File is too small for BRIG or ELF");
+    VALIDATE(fd.pread((char*)&moduleHdr, sizeof(BrigModuleHeader), 0) == 0, "Failed to read BrigModuleHeader");
+
+    if (validateModuleHeader(fd, moduleHdr, fileSize)) return 1;
+
+    uint64_t secIdxSize = moduleHdr.sectionCount * sizeof(uint64_t);
+
     map[0]                      = sizeof(BrigModuleHeader);
     map[moduleHdr.sectionIndex] = secIdxSize;
 
@@ -1142,4 +1400,197 @@ uint64_t BrigIO::validateSection(ReadAdapter&    fd,
     return sectionHeader.byteCount;
 }
 
+// --------------------------------------------------------------------------------
+// FUSED LOADER AND STRUCTURAL VALIDATOR
+
+#define VERIFY_CHUNK_SIZE                   (1024*1024)
+#define MIN_DATA_ITEM_SIZE                   (4)
+
+#define VERIFY_ITEM(offset, cond, msg) if (!(cond)) { \
+    errs << "Error in " << brigSectionNameById(sectionId) << " section, at offset " << (offset) << ":\n" << msg << std::endl; \
+    return 1; }
+
+// Walks items of a standard section as soon as its bytes are read,
+// performing the same item layout checks as the low-level part of
+// Validator and recording offsets of the items.
+class SectionItemWalker {
+    int                 sectionId;
+    const char*         secData;
+    uint64_t            sectionOffset; // in the module
+    uint32_t            secSize;
+    uint32_t            cur;           // offset of the next item in the section
+    std::vector<Offset> items;
+
+public:
+    SectionItemWalker()
+        : sectionId(-1), secData(0), sectionOffset(0), secSize(0), cur(0) {}
+
+    bool isStarted() const { return secData != 0; }
+    bool isDone() const { return isStarted() && cur == secSize; }
+
+    // header of the section must be already read and checked by validateSection
+    int start(int id, const char* module, uint64_t ofs, std::ostream& errs) {
+        const BrigSectionHeader* header = (const BrigSectionHeader*)(module + ofs);
+        sectionId = id;
+        VERIFY_ITEM(0, (header->byteCount & 0xFFFFFFFF00000000ULL) == 0, "Size of standard sections must not exceed 0xFFFFFFFC");
+        secData = module + ofs;
+        sectionOffset = ofs;
+        secSize = (uint32_t)header->byteCount;
+        cur = header->headerByteCount;
+        items.reserve(secSize / 32);
+        return 0;
+    }
+
+    // checks all items which are completely within first 'avail' bytes of the module
+    int advance(uint64_t avail, std::ostream& errs) {
+        assert(isStarted() && avail >= sectionOffset);
+
+        uint32_t const secAvail = (uint32_t)std::min<uint64_t>(avail - sectionOffset, secSize);
+        uint32_t const entryHeaderSize = (sectionId == BRIG_SECTION_INDEX_DATA)? offsetof(BrigData, bytes) : sizeof(BrigBase);
+
+        while (cur < secSize) {
+            VERIFY_ITEM(cur, cur < cur + entryHeaderSize && // no overflow
+                             cur + entryHeaderSize <= secSize, "Last item does not fit in section");
+            if (cur + entryHeaderSize > secAvail) break; // not read yet
+
+            unsigned itemSize;
+            unsigned minItemSize;
+            if (sectionId == BRIG_SECTION_INDEX_DATA) {
+                unsigned const byteCount = ((const BrigData*)(secData + cur))->byteCount;
+                unsigned const size = ((byteCount + 7) / 4) * 4;
+                itemSize = (size > byteCount)? size : 0xFFFFFFFC;
+                minItemSize = MIN_DATA_ITEM_SIZE;
+            } else {
+                const BrigBase* item = (const BrigBase*)(secData + cur);
+                int const size = size_of_brig_record(item->kind);
+                VERIFY_ITEM(cur, size > 0, "Invalid item kind");
+                itemSize = item->byteCount;
+                minItemSize = size;
+            }
+            VERIFY_ITEM(cur, (itemSize & 0x3) == 0,        "Item size must be a multiple of 4");
+            VERIFY_ITEM(cur, minItemSize <= itemSize,      "Invalid item size");
+            VERIFY_ITEM(cur, cur + itemSize > cur && // no overflow
+                             cur + itemSize <= secSize,    "Item does not fit in section");
+            if (cur + itemSize > secAvail) break; // not read yet
+
+            if (sectionId == BRIG_SECTION_INDEX_DATA) {
+                const BrigData* data = (const BrigData*)(secData + cur);
+                unsigned const size = itemSize - offsetof(BrigData, bytes);
+                for (unsigned i = data->byteCount; i < size; ++i) {
+                    VERIFY_ITEM(cur, data->bytes[i] == 0, "Padding bytes at the end of hsa_data items must be 0");
+                }
+            }
+            items.push_back(cur);
+            cur += itemSize;
+        }
+        return 0;
+    }
+
+    void takeItems(std::vector<Offset>& dst) { dst.swap(items); }
+};
+
+#undef VERIFY_ITEM
+
+class VerifyingBrigReader {
+    ReadAdapter&        fd;
+    std::vector<char>   buf;
+    uint64_t            fileSize;
+    uint64_t            avail;   // number of bytes read so far
+    SectionItemWalker   walkers[BRIG_SECTION_INDEX_IMPLEMENTATION_DEFINED];
+
+    // checks whatever became available after reading the next chunk
+    int advance() {
+        const BrigModuleHeader* moduleHdr = (const BrigModuleHeader*)&buf[0];
+        if (moduleHdr->sectionIndex + BRIG_SECTION_INDEX_IMPLEMENTATION_DEFINED * sizeof(uint64_t) > avail) return 0;
+
+        const uint64_t* sectionIndex = (const uint64_t*)&buf[(size_t)moduleHdr->sectionIndex];
+        for (int i = 0; i < BRIG_SECTION_INDEX_IMPLEMENTATION_DEFINED; ++i) {
+            SectionItemWalker& w = walkers[i];
+            if (!w.isStarted()) {
+                uint64_t const ofs = sectionIndex[i];
+                if (avail < fileSize &&
+                    (ofs > avail || avail - ofs < sizeof(BrigSectionHeader) + MAX_PREDEFINED_SECTION_NAME_LENGTH)) {
+                    continue; // header is not read yet
+                }
+                MemoryAdapter mem(&buf[0], (size_t)avail, fd.errs);
+                if (BrigIO::validateSection(mem, i, ofs, fileSize) == 1) return 1;
+                if (w.start(i, &buf[0], ofs, fd.errs)) return 1;
+            }
+            if (w.advance(avail, fd.errs)) return 1;
+        }
+        return 0;
+    }
+
+public:
+    VerifyingBrigReader(ReadAdapter& fd_)
+        : fd(fd_), fileSize(0), avail(0) {}
+
+    int read(BrigContainer& c) {
+        BrigModuleHeader moduleHdr;
+
+        fileSize = (uint64_t)fd.getSize();
+        VALIDATE(fileSize != (uint64_t)-1, "Filed to read file size");
+
+        VALIDATE(fileSize > sizeof(BrigModuleHeader), "File is too small for BRIG or ELF");
+        VALIDATE(fd.pread((char*)&moduleHdr, sizeof(BrigModuleHeader), 0) == 0, "Failed to read BrigModuleHeader");
+        VALIDATE(fileSize < (std::numeric_limits<size_t>::max)(), "Brig is too big");
+
+        if (validateModuleHeader(fd, moduleHdr, fileSize)) return 1;
+
+        buf.resize((size_t)fileSize);
+        memcpy(&buf[0], &moduleHdr, sizeof moduleHdr);
+        avail = sizeof moduleHdr;
+
+        // items are checked chunk by chunk right after reading,
+        // while the bytes are still in cache
+        while (avail < fileSize) {
+            size_t const n = (size_t)std::min<uint64_t>(VERIFY_CHUNK_SIZE, fileSize - avail);
+            VALIDATE(fd.pread(&buf[(size_t)avail], n, avail) == 0, "cannot read Brig");
+            avail += n;
+            if (advance()) return 1;
+        }
+        for (int i = 0; i < BRIG_SECTION_INDEX_IMPLEMENTATION_DEFINED; ++i) {
+            assert(walkers[i].isDone());
+        }
+
+        // the rest of module layout checks (overlapping, gaps and padding)
+        // only touch headers, which are in memory now
+        if (BrigIO::validateBrigBlob(*BrigIO::memoryReadingAdapter(&buf[0], buf.size(), fd.errs))) return 1;
+
+        std::vector< std::vector<Offset> > itemIndex(BRIG_SECTION_INDEX_IMPLEMENTATION_DEFINED);
+        for (int i = 0; i < BRIG_SECTION_INDEX_IMPLEMENTATION_DEFINED; ++i) {
+            walkers[i].takeItems(itemIndex[i]);
+        }
+        c.setContents(buf);
+        c.setStructurallyVerified(itemIndex);
+        return 0;
+    }
+};
+
+int BrigIO::loadVerified(BrigContainer &dst,
+                         int           fmt,
+                         ReadAdapter&  src)
+{
+    unsigned char ident[16];
+    if (0 != src.pread((char*)ident, 16, 0)) {
+        return 1;
+    }
+    if (memcmp("HSA BRIG", ident, 8)==0) {
+        return VerifyingBrigReader(src).read(dst);
+    }
+    switch(ident[EI_CLASS]) {
+    case Elf32Policy::ELFCLASS: {
+        BrigIOImpl<Elf32Policy> impl(fmt);
+        return impl.readContainer(dst, &src, true);
+        }
+    case Elf64Policy::ELFCLASS: {
+        BrigIOImpl<Elf64Policy> impl(fmt);
+        return impl.readContainer(dst, &src, true);
+        }
+    default:
+        src.errs << "Unsupported file format" << std::endl;
+        return 1;
+    }
+}
+
 }
@@ -61,7 +61,9 @@ enum BinaryFileFormat {
     FILE_FORMAT_BIF  = 2,
     FILE_FORMAT_MASK = 0xf,
     FILE_FORMAT_ELF32 = 0,
-    FILE_FORMAT_ELF64 = 0x10
+    FILE_FORMAT_ELF64 = 0x10,
+    FILE_FORMAT_ELF_MASK = 0xf0,
+    FILE_FORMAT_SYMBOL_INDEX = 0x100 // save: (re)build symbol index section before writing
 };
 
 /// virtual base for the adapters
@@ -122,6 +124,31 @@ public:
     }
 };
 
+/// forward-only wrapper which counts written bytes itself instead of
+/// querying the underlying adapter, so that writers never seek it. This is
+/// what makes saving to pipes and other non-seekable destinations possible.
+/// Positions are relative to the point where the wrapper was created.
+class SequentialWriteAdapter : public WriteAdapter {
+    WriteAdapter&    w;
+    mutable Position pos;
+public:
+    SequentialWriteAdapter(WriteAdapter& w_)
+        : IOAdapter(w_.errs)
+        , WriteAdapter(w_.errs)
+        , w(w_)
+        , pos(0)
+    {}
+    virtual Position getPos() const { return pos; }
+    virtual void setPos(Position p) { assert(p == pos && "cannot seek sequential output"); }
+    virtual int write(const char* data, size_t numBytes) const {
+        if (w.write(data, numBytes)) {
+            return 1;
+        }
+        pos += (Position)numBytes;
+        return 0;
+    }
+};
+
 /// read-only adapter
 class ReadAdapter : public virtual IOAdapter {
 public:
@@ -133,6 +160,19 @@ public:
     virtual int pread(char* data, size_t numBytes, uint64_t ofs) const = 0;
     virtual Position getSize() const { return (Position)-1; };
 
+    /// pointer to numBytes at ofs if the adapter already keeps them in memory,
+    /// valid until the next view, pread or releaseContents call (a buffering
+    /// adapter may reallocate its buffer); NULL means pread has to be used
+    virtual const char* view(uint64_t, size_t) const { return 0; }
+
+    /// hands over the whole contents if the adapter keeps them in its own
+    /// buffer, so that they do not need to be copied; the adapter is empty then
+    virtual bool releaseContents(std::vector<char>&) { return false; }
+
+    /// reads numBytes at ofs into dst. The bytes are copied once, from view()
+    /// when possible, otherwise by pread
+    int readInto(std::vector<char>& dst, size_t numBytes, uint64_t ofs) const;
+
     virtual ~ReadAdapter() = 0;
 };
 
@@ -161,6 +201,11 @@ struct BrigIO {
                     const char*                 fileName,
                     std::ostream&               errs = defaultErrs());
 
+    // writes to the standard output which may be a pipe, the output is
+    // never seeked
+    static std::unique_ptr<WriteAdapter> stdoutWritingAdapter(
+                    std::ostream&               errs = defaultErrs());
+
     static std::unique_ptr<ReadAdapter> memoryReadingAdapter(
                     const char                 *buf,
                     size_t                      size,
@@ -213,6 +258,38 @@ struct BrigIO {
         return !src.get() || load(dst, fmt, *src);
     }
 
+    // loads BRIG reading it sequentially in large chunks and performing
+    // low-level structural validation of each chunk as soon as it is read.
+    // On success dst is marked as structurally verified, so Validator
+    // does not walk the sections again.
+    static int loadVerified(BrigContainer&       dst,
+                            int                  fmt,
+                            ReadAdapter&         src);
+
+    static int loadVerified(BrigContainer&               dst,
+                            int                          fmt,
+                            std::unique_ptr<ReadAdapter>   src)
+    {
+        return !src.get() || loadVerified(dst, fmt, *src);
+    }
+
+    // handing BRIG over to another process without copying it through files.
+    // exportToSharedMemory places the module of the container (laid out
+    // as makeRO does) into an anonymous shared memory object and returns its
+    // file descriptor, or -1 on failure. The descriptor may be inherited or
+    // passed over a unix socket; the receiver calls mapSharedMemory and wraps
+    // the result into the RO container, BrigContainer(const BrigModuleHeader*).
+    // The mapping must outlive the container and is released with
+    // unmapSharedMemory. Not supported on Windows.
+
+    static int exportToSharedMemory(const BrigContainer& src,
+                                    std::ostream&        errs = defaultErrs());
+
+    static const BrigModuleHeader* mapSharedMemory(int fd,
+                                    std::ostream&        errs = defaultErrs());
+
+    static void unmapSharedMemory(const BrigModuleHeader* module);
+
     static int validateBrigBlob(ReadAdapter&         src);
 
     static uint64_t validateSection(ReadAdapter&     fd, 
@@ -93,6 +93,34 @@ void Brigantine::startProgram()
     m_globalScope.reset(new Scope(&m_container));
 }
 
+void Brigantine::resumeProgram(Offset till)
+{
+    startProgram();
+    for(Code c = m_container.code().begin(); c.brigOffset() < till; ) {
+        if (DirectiveExecutable func = c) {
+            if (!m_globalScope->get<DirectiveExecutable>(func.name())) {
+                addSymbolToGlobalScope(func);
+            }
+            c = func.nextModuleEntry();
+            continue;
+        }
+        if (DirectiveVariable var = c) {
+            if (isGlobalName(var.name())) {
+                addSymbolToGlobalScope(var);
+            }
+        } else if (DirectiveFbarrier fbar = c) {
+            if (isGlobalName(fbar.name())) {
+                m_globalScope->add(fbar.name(), fbar);
+            }
+        } else if (DirectiveModule module = c) {
+            m_profile = module.profile();
+            m_machine = module.machineModel();
+            addSymbolToGlobalScope(module);
+        }
+        c = c.next();
+    }
+}
+
 void Brigantine::endProgram()
 {
     m_globalScope.reset();
@@ -197,7 +225,8 @@ void Brigantine::startBody()
     assert(m_func && m_funcScope.get()==NULL);
 
     m_func.modifier().isDefinition() = true;
-    m_funcScope.reset(new Scope(&m_container));
+    openScope(m_funcScope, m_freeFuncScope);
+    clearLabelRefs();
     m_func.firstCodeBlockEntry() = m_container.code().end();
 
     DirectiveExecutable func = m_func;
@@ -230,7 +259,8 @@ bool Brigantine::endBody()
 
     m_func.nextModuleEntry() = m_container.code().end();
 
-    m_funcScope.reset();
+    clearLabelRefs();
+    closeScope(m_funcScope, m_freeFuncScope);
     DirectiveExecutable fx = m_func;
     m_func = Directive();
     return true;
@@ -238,14 +268,25 @@ bool Brigantine::endBody()
 
 bool Brigantine::checkForUnboundLabels()
 {
-    if (!m_labelMap.empty()) {
-        const RefList& list = (*m_labelMap.begin()).second;
-        brigWriteError("label doesn't exist", &list.front().second);
-        return false;
+    if (m_numPendingLabels > 0) {
+        for(size_t i = 0; i < m_labelRefs.size(); ++i) {
+            if (m_pendingLabels[m_labelRefs[i].label]!=NO_LABEL_REF) {
+                brigWriteError("label doesn't exist", &m_labelRefs[i].srcInfo);
+                return false;
+            }
+        }
     }
     return true;
 }
 
+void Brigantine::clearLabelRefs()
+{
+    m_pendingLabelIds.clear();
+    m_pendingLabels.clear();
+    m_labelRefs.clear();
+    m_numPendingLabels = 0;
+}
+
 DirectiveArgBlockStart Brigantine::startArgScope(const SourceInfo* srcInfo)
 {
     if (m_argScope.get()!=NULL) {
@@ -256,13 +297,13 @@ DirectiveArgBlockStart Brigantine::startArgScope(const SourceInfo* srcInfo)
     DirectiveArgBlockStart s = m_container.append<DirectiveArgBlockStart>();
     annotate(s,srcInfo);
 
-    m_argScope.reset(new Scope(&m_container));
+    openScope(m_argScope, m_freeArgScope);
     return s;
 }
 
 DirectiveArgBlockEnd Brigantine::endArgScope(const SourceInfo* srcInfo)
 {
-    m_argScope.reset();
+    closeScope(m_argScope, m_freeArgScope);
     DirectiveArgBlockEnd e = m_container.append<DirectiveArgBlockEnd>();
     annotate(e,srcInfo);
     return e;
@@ -278,21 +319,29 @@ void Brigantine::recordLabelRef(ItemRef<Code> ref, const SRef& name, const Sourc
     if (lbl) {
         ref = lbl;
     } else {
-        Offset const nameOfs = m_container.addString(name);
-        m_labelMap[nameOfs].push_back(std::make_pair(ref,srcInfo ? *srcInfo : SourceInfo()));
+        bool added;
+        unsigned const id = *m_pendingLabelIds.insert(name, (unsigned)m_pendingLabels.size(), added);
+        if (added) {
+            m_pendingLabels.push_back(NO_LABEL_REF);
+            ++m_numPendingLabels;
+        }
+        LabelRef const labelRef = { ref, srcInfo ? *srcInfo : SourceInfo(), id, m_pendingLabels[id] };
+        m_pendingLabels[id] = (unsigned)m_labelRefs.size();
+        m_labelRefs.push_back(labelRef);
     }
 }
 
-void Brigantine::patchLabelRefs(DirectiveLabel label)
+void Brigantine::patchLabelRefs(DirectiveLabel label, const SRef& name)
 {
-    LabelMap::iterator l = m_labelMap.find(label.name().deref());
-    if (l!=m_labelMap.end()) {
-        const RefList &refList = (*l).second;
-        for(RefList::const_iterator i=refList.begin(), e=refList.end(); i!=e; ++i) {
-            ItemRef<Code> ref = (*i).first;
-            ref = label;
+    if (m_numPendingLabels==0) return;
+    const unsigned* const id = m_pendingLabelIds.find(name);
+    if (id!=NULL && m_pendingLabels[*id]!=NO_LABEL_REF) {
+        for(unsigned i = m_pendingLabels[*id]; i!=NO_LABEL_REF; i = m_labelRefs[i].next) {
+            ItemRef<Code> slot = m_labelRefs[i].slot;
+            slot = label;
         }
-        m_labelMap.erase(l);
+        m_pendingLabels[*id] = NO_LABEL_REF;
+        --m_numPendingLabels;
     }
 }
 
@@ -404,7 +453,7 @@ DirectiveLabel Brigantine::addLabel(const SRef& name,const SourceInfo* srcInfo)
 {
     DirectiveLabel lbl = addLabelInternal(name,srcInfo);
     if (lbl) {
-        patchLabelRefs(lbl);
+        patchLabelRefs(lbl,name);
     }
     return lbl;
 }
@@ -600,6 +649,21 @@ OperandCodeRef Brigantine::createCodeRef(Code c,const SourceInfo* srcInfo)
     return operand;
 }
 
+void Brigantine::openScope(std::unique_ptr<Scope>& scope, std::unique_ptr<Scope>& freeScope) {
+    if (freeScope.get()!=NULL) {
+        scope = std::move(freeScope);
+    } else {
+        scope.reset(new Scope(&m_container));
+    }
+}
+
+void Brigantine::closeScope(std::unique_ptr<Scope>& scope, std::unique_ptr<Scope>& freeScope) {
+    if (scope.get()!=NULL) {
+        scope->clear();
+        freeScope = std::move(scope);
+    }
+}
+
 void Brigantine::addSymbolToGlobalScope(DirectiveExecutable sym) {
     assert(isGlobalName(sym.name()));
     assert(m_globalScope.get()!=NULL);
@@ -641,7 +705,7 @@ void Brigantine::addSymbolToLocalScope(DirectiveVariable sym) {
 
 // **NB** This function should only be called by Parser. Lowering code should use setOperandEx
 
-void Brigantine::setOperands(Inst inst, ItemList operands)
+void Brigantine::setOperands(Inst inst, const ItemList& operands)
 {
     inst.operands() = operands;
 
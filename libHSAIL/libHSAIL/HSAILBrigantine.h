@@ -65,14 +65,27 @@ class Brigantine
     std::unique_ptr<Scope>    m_globalScope;
     std::unique_ptr<Scope>    m_funcScope;
     std::unique_ptr<Scope>    m_argScope;
+    std::unique_ptr<Scope>    m_freeFuncScope; // ended scopes kept for reuse
+    std::unique_ptr<Scope>    m_freeArgScope;
     DirectiveExecutable     m_func;
     unsigned                m_machine;
     unsigned                m_profile;
 
-    typedef std::vector< std::pair< ItemRef<Code>, SourceInfo > > RefList;
-    typedef std::map<BrigStringOffset32_t, RefList> LabelMap;
-
-    LabelMap m_labelMap; // string offset -> array of label refs
+    // references to labels not defined yet in the current function; the
+    // references to a label are linked through 'next' starting at the
+    // label's entry in m_pendingLabels
+    struct LabelRef {
+        ItemRef<Code> slot;
+        SourceInfo    srcInfo;
+        unsigned      label;
+        unsigned      next;
+    };
+    enum { NO_LABEL_REF = 0xFFFFFFFF };
+
+    NameMap                 m_pendingLabelIds; // name -> index in m_pendingLabels
+    std::vector<unsigned>   m_pendingLabels;   // last reference, NO_LABEL_REF once defined
+    std::vector<LabelRef>   m_labelRefs;
+    unsigned                m_numPendingLabels;
 
     Brigantine& operator=(const Brigantine&);
 
@@ -83,12 +96,18 @@ public:
     /// won't syncronize it's state with it and therefore it is up to the user to
     /// supply the container in a state that allows to 'continue' writing consistently.
     /// Most common case is an empty Brig container.
-    Brigantine(BrigContainer& container) : m_container(container), m_machine(BRIG_MACHINE_UNDEF), m_profile(BRIG_PROFILE_UNDEF) {}
+    Brigantine(BrigContainer& container) : m_container(container), m_machine(BRIG_MACHINE_UNDEF), m_profile(BRIG_PROFILE_UNDEF), m_numPendingLabels(0) {}
     virtual ~Brigantine() {}
 
     /// start HSAIL program. While it doesn't write anything to the container it
     /// prepares Brigantine's state to begin Brig emitting.
     void startProgram();
+    /// start HSAIL program continuing the one in the container before
+    /// the code offset 'till'. Module scope symbols declared there are
+    /// visible to what is written next, the module statement sets machine
+    /// model and profile.
+    /// @param till - code offset of a top-level statement.
+    void resumeProgram(Offset till);
     /// end HSAIL program.
     /// Perform Brigantine's state cleanup.
     void endProgram();
@@ -154,6 +173,15 @@ public:
     /// @param srcInfo - (optional) source location
     DirectiveArgBlockEnd endArgScope(const SourceInfo* srcInfo=NULL);
 
+    /// executable declared last, null after its body has ended.
+    DirectiveExecutable currentExecutable() const { return m_func; }
+
+    /// true between startBody and endBody.
+    bool isInBody() const { return m_funcScope.get()!=NULL; }
+
+    /// true between startArgScope and endArgScope.
+    bool isInArgScope() const { return m_argScope.get()!=NULL; }
+
     /// @}
 
 
@@ -211,7 +239,7 @@ public:
     /// @}
 
 
-    void setOperands(Inst inst, ItemList operands);
+    void setOperands(Inst inst, const ItemList& operands);
     //void setOperandEx(Inst inst, int i, Operand opnd);
 
     template<typename Item>
@@ -413,6 +441,9 @@ private:
 
     DirectiveExecutable declFuncCommon(DirectiveExecutable func, const SRef& name, const SourceInfo* srcInfo);
 
+    void openScope(std::unique_ptr<Scope>& scope, std::unique_ptr<Scope>& freeScope);
+    static void closeScope(std::unique_ptr<Scope>& scope, std::unique_ptr<Scope>& freeScope);
+
     void addSymbolToLocalScope(DirectiveVariable sym);
     void addSymbolToFunctionScope(DirectiveVariable sym);
     void addSymbolToGlobalScope(DirectiveExecutable sym);
@@ -420,8 +451,9 @@ private:
     void addSymbolToGlobalScope(DirectiveModule sym);
 
     bool checkForUnboundLabels();
+    void clearLabelRefs();
     void recordLabelRef(ItemRef<Code> ref, const SRef& name, const SourceInfo*);
-    void patchLabelRefs(DirectiveLabel label);
+    void patchLabelRefs(DirectiveLabel label, const SRef& name);
 
     DirectiveLabel addLabelInternal(const SRef& name,const SourceInfo* srcInfo);
 
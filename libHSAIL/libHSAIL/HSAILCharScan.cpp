@@ -0,0 +1,280 @@
+// University of Illinois/NCSA
+// Open Source License
+//
+// Copyright (c) 2013-2015, Advanced Micro Devices, Inc.
+// All rights reserved.
+//
+// Developed by:
+//
+//     HSA Team
+//
+//     Advanced Micro Devices, Inc
+//
+//     www.amd.com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the "Software"), to deal with
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+//     * Redistributions of source code must retain the above copyright notice,
+//       this list of conditions and the following disclaimers.
+//
+//     * Redistributions in binary form must reproduce the above copyright notice,
+//       this list of conditions and the following disclaimers in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the names of the LLVM Team, University of Illinois at
+//       Urbana-Champaign, nor the names of its contributors may be used to
+//       endorse or promote products derived from this Software without specific
+//       prior written permission.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS WITH THE
+// SOFTWARE.
+#include "HSAILCharScan.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define HSAIL_CHAR_SCAN_SSE2 1
+#include <emmintrin.h>
+#if defined(__GNUC__) || defined(_MSC_VER)
+#define HSAIL_CHAR_SCAN_AVX2 1
+#include <immintrin.h>
+#endif
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+#if defined(HSAIL_CHAR_SCAN_AVX2) && defined(__GNUC__)
+#define HSAIL_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define HSAIL_TARGET_AVX2
+#endif
+
+namespace HSAIL_ASM
+{
+
+namespace {
+
+// ============================================================================
+// Scalar
+
+const char* skipSpacesScalar(const char* p, const char* end)
+{
+    while (p < end && (*p == ' ' || *p == '\t')) ++p;
+    return p;
+}
+
+const char* findFirstOfScalar(const char* p, const char* end, char c0, char c1, char c2, char c3)
+{
+    for(; p < end; ++p) {
+        char const c = *p;
+        if (c == c0 || c == c1 || c == c2 || c == c3) break;
+    }
+    return p;
+}
+
+#ifdef HSAIL_CHAR_SCAN_SSE2
+
+inline unsigned lowestBit(unsigned mask)
+{
+#ifdef _MSC_VER
+    unsigned long idx;
+    _BitScanForward(&idx, mask);
+    return idx;
+#else
+    return __builtin_ctz(mask);
+#endif
+}
+
+// ============================================================================
+// SSE2, 16 bytes per step
+
+const char* skipSpacesSse2(const char* p, const char* end)
+{
+    __m128i const space = _mm_set1_epi8(' ');
+    __m128i const tab   = _mm_set1_epi8('\t');
+    while (end - p >= 16) {
+        __m128i const v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        unsigned const blank = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(v, space), _mm_cmpeq_epi8(v, tab)));
+        if (blank != 0xFFFF) return p + lowestBit(~blank);
+        p += 16;
+    }
+    return skipSpacesScalar(p, end);
+}
+
+const char* findFirstOfSse2(const char* p, const char* end, char c0, char c1, char c2, char c3)
+{
+    __m128i const v0 = _mm_set1_epi8(c0);
+    __m128i const v1 = _mm_set1_epi8(c1);
+    __m128i const v2 = _mm_set1_epi8(c2);
+    __m128i const v3 = _mm_set1_epi8(c3);
+    while (end - p >= 16) {
+        __m128i const v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        __m128i const eq = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, v0), _mm_cmpeq_epi8(v, v1)),
+                                        _mm_or_si128(_mm_cmpeq_epi8(v, v2), _mm_cmpeq_epi8(v, v3)));
+        unsigned const found = _mm_movemask_epi8(eq);
+        if (found) return p + lowestBit(found);
+        p += 16;
+    }
+    return findFirstOfScalar(p, end, c0, c1, c2, c3);
+}
+
+#endif // HSAIL_CHAR_SCAN_SSE2
+
+#ifdef HSAIL_CHAR_SCAN_AVX2
+
+// ============================================================================
+// AVX2, 32 bytes per step
+
+HSAIL_TARGET_AVX2
+const char* skipSpacesAvx2(const char* p, const char* end)
+{
+    __m256i const space = _mm256_set1_epi8(' ');
+    __m256i const tab   = _mm256_set1_epi8('\t');
+    while (end - p >= 32) {
+        __m256i const v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        unsigned const blank = static_cast<unsigned>(_mm256_movemask_epi8(
+            _mm256_or_si256(_mm256_cmpeq_epi8(v, space), _mm256_cmpeq_epi8(v, tab))));
+        if (blank != 0xFFFFFFFFu) return p + lowestBit(~blank);
+        p += 32;
+    }
+    return skipSpacesSse2(p, end);
+}
+
+HSAIL_TARGET_AVX2
+const char* findFirstOfAvx2(const char* p, const char* end, char c0, char c1, char c2, char c3)
+{
+    __m256i const v0 = _mm256_set1_epi8(c0);
+    __m256i const v1 = _mm256_set1_epi8(c1);
+    __m256i const v2 = _mm256_set1_epi8(c2);
+    __m256i const v3 = _mm256_set1_epi8(c3);
+    while (end - p >= 32) {
+        __m256i const v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        __m256i const eq = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(v, v0), _mm256_cmpeq_epi8(v, v1)),
+                                           _mm256_or_si256(_mm256_cmpeq_epi8(v, v2), _mm256_cmpeq_epi8(v, v3)));
+        unsigned const found = static_cast<unsigned>(_mm256_movemask_epi8(eq));
+        if (found) return p + lowestBit(found);
+        p += 32;
+    }
+    return findFirstOfSse2(p, end, c0, c1, c2, c3);
+}
+
+bool cpuHasAvx2()
+{
+#ifdef _MSC_VER
+    int regs[4];
+    __cpuid(regs, 0);
+    if (regs[0] < 7) return false;
+    __cpuid(regs, 1);
+    bool const osxsave = (regs[2] & (1 << 27)) != 0;
+    bool const avx     = (regs[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx || (_xgetbv(0) & 6) != 6) return false; // ymm state saved by the OS
+    __cpuidex(regs, 7, 0);
+    return (regs[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") != 0;
+#endif
+}
+
+#endif // HSAIL_CHAR_SCAN_AVX2
+
+// ============================================================================
+// Dispatch
+
+struct CharScanImpl {
+    CharScanIsa isa;
+    const char* (*skipSpaces)(const char*, const char*);
+    const char* (*findFirstOf)(const char*, const char*, char, char, char, char);
+};
+
+CharScanImpl const charScanImpls[] = {
+    { CHAR_SCAN_SCALAR, skipSpacesScalar, findFirstOfScalar },
+#ifdef HSAIL_CHAR_SCAN_SSE2
+    { CHAR_SCAN_SSE2,   skipSpacesSse2,   findFirstOfSse2 },
+#endif
+#ifdef HSAIL_CHAR_SCAN_AVX2
+    { CHAR_SCAN_AVX2,   skipSpacesAvx2,   findFirstOfAvx2 },
+#endif
+};
+
+bool isSupported(CharScanIsa isa)
+{
+    switch(isa) {
+    case CHAR_SCAN_SCALAR: return true;
+#ifdef HSAIL_CHAR_SCAN_SSE2
+    case CHAR_SCAN_SSE2:   return true;
+#endif
+#ifdef HSAIL_CHAR_SCAN_AVX2
+    case CHAR_SCAN_AVX2:   { static bool const avx2 = cpuHasAvx2(); return avx2; }
+#endif
+    default:               return false;
+    }
+}
+
+const CharScanImpl* bestImpl()
+{
+    const CharScanImpl* best = &charScanImpls[0];
+    for(unsigned i = 1; i < sizeof charScanImpls / sizeof charScanImpls[0]; ++i) {
+        if (isSupported(charScanImpls[i].isa)) best = &charScanImpls[i];
+    }
+    return best;
+}
+
+const CharScanImpl*& currentImpl()
+{
+    static const CharScanImpl* impl = bestImpl();
+    return impl;
+}
+
+} // end anonymous namespace
+
+const char* skipSpaces(const char* p, const char* end)
+{
+    // most lines are indented by a tab or a few spaces, don't pay for a vector load
+    if (p < end && *p != ' ' && *p != '\t') return p;
+    return currentImpl()->skipSpaces(p, end);
+}
+
+const char* findFirstOf(const char* p, const char* end, char c0, char c1, char c2, char c3)
+{
+    return currentImpl()->findFirstOf(p, end, c0, c1, c2, c3);
+}
+
+CharScanIsa charScanIsa()
+{
+    return currentImpl()->isa;
+}
+
+bool setCharScanIsa(CharScanIsa isa)
+{
+    if (!isSupported(isa)) return false;
+    for(unsigned i = 0; i < sizeof charScanImpls / sizeof charScanImpls[0]; ++i) {
+        if (charScanImpls[i].isa == isa) {
+            currentImpl() = &charScanImpls[i];
+            return true;
+        }
+    }
+    return false;
+}
+
+const char* charScanIsaName(CharScanIsa isa)
+{
+    switch(isa) {
+    case CHAR_SCAN_SCALAR: return "scalar";
+    case CHAR_SCAN_SSE2:   return "sse2";
+    case CHAR_SCAN_AVX2:   return "avx2";
+    default:               return "unknown";
+    }
+}
+
+} // end namespace
@@ -0,0 +1,76 @@
+// University of Illinois/NCSA
+// Open Source License
+//
+// Copyright (c) 2013-2015, Advanced Micro Devices, Inc.
+// All rights reserved.
+//
+// Developed by:
+//
+//     HSA Team
+//
+//     Advanced Micro Devices, Inc
+//
+//     www.amd.com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the "Software"), to deal with
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+//     * Redistributions of source code must retain the above copyright notice,
+//       this list of conditions and the following disclaimers.
+//
+//     * Redistributions in binary form must reproduce the above copyright notice,
+//       this list of conditions and the following disclaimers in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the names of the LLVM Team, University of Illinois at
+//       Urbana-Champaign, nor the names of its contributors may be used to
+//       endorse or promote products derived from this Software without specific
+//       prior written permission.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS WITH THE
+// SOFTWARE.
+#pragma once
+#ifndef INCLUDED_HSAIL_CHAR_SCAN_H
+#define INCLUDED_HSAIL_CHAR_SCAN_H
+
+namespace HSAIL_ASM
+{
+
+/// Byte searches used by the scanner for the long runs it does not need to
+/// tokenize: indentation, single line comments and multiline comment bodies.
+/// Each search has a scalar, an SSE2 and an AVX2 variant; the best one the
+/// cpu supports is selected on first use. Searches never read past end.
+
+enum CharScanIsa {
+    CHAR_SCAN_SCALAR,
+    CHAR_SCAN_SSE2,
+    CHAR_SCAN_AVX2
+};
+
+/// Returns the first byte in [p,end) which is neither space nor tab, end if none.
+const char* skipSpaces(const char* p, const char* end);
+
+/// Returns the first byte in [p,end) equal to one of c0..c3, end if none.
+const char* findFirstOf(const char* p, const char* end, char c0, char c1, char c2, char c3);
+
+/// Implementation currently used by the searches.
+CharScanIsa charScanIsa();
+
+/// Forces an implementation (for testing and benchmarking). Returns false
+/// and keeps the current one if the cpu does not support it.
+bool setCharScanIsa(CharScanIsa isa);
+
+const char* charScanIsaName(CharScanIsa isa);
+
+} // end namespace
+
+#endif // INCLUDED_HSAIL_CHAR_SCAN_H
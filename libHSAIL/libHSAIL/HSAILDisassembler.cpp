@@ -44,9 +44,14 @@
 #include "HSAILUtilities.h"
 #include "HSAILb128_t.h"
 
+#include <algorithm>
+#include <atomic>
 #include <fstream>
 #include <iomanip>
 #include <cmath>
+#include <memory>
+#include <thread>
+#include <vector>
 
 // ============================================================================
 // Public API
@@ -84,6 +89,12 @@ namespace
         return os;
     }
 
+    HSAIL_ASM::OutputBuffer& operator<<(HSAIL_ASM::OutputBuffer& out, const PrintHex& ph)
+    {
+        out.putHex(ph.data, ph.numBytes);
+        return out;
+    }
+
 } // noname namespace
 
 namespace HSAIL_ASM
@@ -103,6 +114,14 @@ inline void printFloatValueImpl(std::ostream& stream, int mode, Float val) {
       // \todo this might require explicit NaN processing in case the standard library is unable to print it properly
       stream.setf(std::ios::showpoint);
       stream << val.floatValue() << IEEE754Traits<Float>::suffix; break;
+    case FloatDisassemblyModeShortest:
+      if ((val.rawBits() & IEEE754Traits<Float>::expMask) == IEEE754Traits<Float>::expMask) {
+          stream << IEEE754Traits<Float>::hexPrefix << PrintHex(val.rawBits());
+      } else {
+          char buf[MAX_FLOAT_LITERAL_LEN];
+          stream.write(buf, toShortestDecimal(val, buf));
+      }
+      break;
     default:
       assert(0);
     }
@@ -118,10 +137,62 @@ void printFloatValue(std::ostream& stream, int mode, f16_t val) {
   return printFloatValueImpl(stream, mode, val);
 }
 
+// Same as above: the decimal form is the one printed by a stream with
+// showpoint and the default precision
+template <typename Float>
+inline void printFloatValueImpl(OutputBuffer& out, int mode, Float val) {
+    switch(mode) {
+    case FloatDisassemblyModeRawBits:
+      out << IEEE754Traits<Float>::hexPrefix << PrintHex(val.rawBits()); break;
+    case FloatDisassemblyModeC99: {
+      char buf[MAX_FLOAT_LITERAL_LEN];
+      out.write(buf, toC99chars(val, buf)); break;
+    }
+    case FloatDisassemblyModeDecimal: {
+      char buf[64];
+      snprintf(buf, sizeof(buf), "%#g", (double)val.floatValue());
+      out << buf << IEEE754Traits<Float>::suffix; break;
+    }
+    case FloatDisassemblyModeShortest:
+      if ((val.rawBits() & IEEE754Traits<Float>::expMask) == IEEE754Traits<Float>::expMask) {
+          out << IEEE754Traits<Float>::hexPrefix << PrintHex(val.rawBits());
+      } else {
+          char buf[MAX_FLOAT_LITERAL_LEN];
+          out.write(buf, toShortestDecimal(val, buf));
+      }
+      break;
+    default:
+      assert(0);
+    }
+}
+
+void printFloatValue(OutputBuffer& out, int mode, f32_t val) {
+  return printFloatValueImpl(out, mode, val);
+}
+void printFloatValue(OutputBuffer& out, int mode, f64_t val) {
+  return printFloatValueImpl(out, mode, val);
+}
+void printFloatValue(OutputBuffer& out, int mode, f16_t val) {
+  return printFloatValueImpl(out, mode, val);
+}
+
+
+int Disassembler::run(OutputBuffer &out) const
+{
+    int res = m_numThreads > 1? runParallel(out) : runSerial(out);
+    out.flush();
+    return res;
+}
 
 int Disassembler::run(std::ostream &s) const
 {
-    stream = &s;
+    OutputBuffer out(s);
+    return run(out);
+}
+
+int Disassembler::runSerial(OutputBuffer &out) const
+{
+    stream = &out;
 
     for (Code d = brig.code().begin(); d != brig.code().end(); d = next(d))
     {
@@ -134,14 +205,115 @@ int Disassembler::run(const char* path) const
 {
     assert(path);
 
-    std::string ErrorInfo;
-    std::ofstream os(path);
+    FILE* f = fopen(path, "w");
+    if (!f) return 1;
 
-    if (!ErrorInfo.empty()) return 1;
+    bool failed;
+    {
+        OutputBuffer out(f);
+        run(out);
+        failed = out.failed();
+    }
+    failed |= fclose(f) != 0;
+    return hasError() || failed;
+}
+
+// Top-level statements disassembled into a private buffer. The state of
+// the disassembler at the start of a partition is the one left by the
+// previous partitions: the machine model is known when partitions are
+// made, the indent is normally zero (it only changes at top level
+// in malformed BRIG) and is checked when partitions are written.
+struct Disassembler::Partition
+{
+    Code               begin;
+    Code               end;
+    unsigned           model;
+    int                startIndent;
+    int                endIndent;
+    bool               hasErr;
+    std::string        text;
+    std::ostringstream log;
+};
+
+int Disassembler::runParallel(OutputBuffer &out) const
+{
+    // partitions are made smaller than a share of a thread
+    // for balance, but big enough to be worth a thread
+    const Offset MIN_PARTITION_SIZE = 64 * 1024;
+
+    Code const begin = brig.code().begin();
+    Code const end   = brig.code().end();
+    Offset const partitionSize = std::max<Offset>((end.brigOffset() - begin.brigOffset()) / (4 * m_numThreads), MIN_PARTITION_SIZE);
+
+    std::vector< std::unique_ptr<Partition> > partitions;
+    unsigned model = mModel;
+    for (Code d = begin; d != end; d = next(d))
+    {
+        if (partitions.empty() || d.brigOffset() - partitions.back()->begin.brigOffset() >= partitionSize)
+        {
+            if (!partitions.empty()) partitions.back()->end = d;
+            std::unique_ptr<Partition> p(new Partition);
+            p->begin = d;
+            p->model = model;
+            p->startIndent = partitions.empty()? indent : 0;
+            partitions.push_back(std::move(p));
+        }
+        if (DirectiveModule m = d) model = m.machineModel();
+    }
+    if (partitions.size() < 2) return runSerial(out);
+    partitions.back()->end = end;
+
+    std::atomic<size_t> nextPartition(0);
+    auto worker = [&]() {
+        for(size_t i; (i = nextPartition++) < partitions.size(); ) {
+            printPartition(*partitions[i], partitions[i]->startIndent);
+        }
+    };
+    std::vector<std::thread> threads;
+    for(size_t i = 1; i < std::min<size_t>(m_numThreads, partitions.size()); ++i) {
+        threads.push_back(std::thread(worker));
+    }
+    worker();
+    for(size_t i = 0; i < threads.size(); ++i) {
+        threads[i].join();
+    }
+
+    for(size_t i = 0; i < partitions.size(); ++i) {
+        Partition& p = *partitions[i];
+        if (p.startIndent != indent) {
+            p.text.clear();
+            p.log.str(string());
+            printPartition(p, indent);
+        }
+        out.write(p.text.data(), p.text.size());
+        if (err) *err << p.log.str();
+        hasErr |= p.hasErr;
+        indent = p.endIndent;
+    }
+    stream = &out;
+    mModel = model;
+    return hasError();
+}
+
+void Disassembler::printPartition(Partition &p, int startIndent) const
+{
+    Disassembler part(brig);
+    part.m_options = m_options;
+    part.mModel    = p.model;
+    part.mProfile  = mProfile;
+    part.indent    = startIndent;
+    part.err       = err? &p.log : 0;
 
-    run(os);
-    os.close();
-    return hasError() || os.bad(); //TBD
+    OutputBuffer out(p.text);
+    part.stream = &out;
+    for (Code d = p.begin; d != p.end; d = part.next(d))
+    {
+        part.printDirectiveFmt(d);
+    }
+    out.flush();
+    p.startIndent = startIndent;
+    p.endIndent   = part.indent;
+    p.hasErr      = part.hasErr;
 }
 
 string Disassembler::get(Directive d, unsigned model, unsigned profile)  { mModel = model; mProfile = profile; return getImpl(d); }
@@ -47,6 +47,7 @@
 #include "HSAILItems.h"
 #include "HSAILUtilities.h"
 #include "HSAILFloats.h"
+#include "HSAILOutputBuffer.h"
 
 #include <iosfwd>
 #include <sstream>
@@ -56,24 +57,30 @@ namespace HSAIL_ASM {
 enum EFloatDisassemblyMode {
     FloatDisassemblyModeRawBits,
     FloatDisassemblyModeC99,
-    FloatDisassemblyModeDecimal
+    FloatDisassemblyModeDecimal,
+    FloatDisassemblyModeShortest  // shortest decimal which reads back exactly, NaNs and infinities as raw bits
 };
 
 void printFloatValue(std::ostream& stream, int mode, f64_t val);
 void printFloatValue(std::ostream& stream, int mode, f16_t val);
 void printFloatValue(std::ostream& stream, int mode, f32_t val);
 
+void printFloatValue(OutputBuffer& out, int mode, f64_t val);
+void printFloatValue(OutputBuffer& out, int mode, f16_t val);
+void printFloatValue(OutputBuffer& out, int mode, f32_t val);
+
 class Disassembler {
 private:
     BrigContainer&        brig;
     std::ostream*         err;
 
-    mutable std::ostream *stream;
+    mutable OutputBuffer *stream;
     mutable int           indent;
     mutable bool          hasErr;
     mutable unsigned      mModel;
     mutable unsigned      mProfile;
     unsigned              m_options;
+    unsigned              m_numThreads;
 
     static const int BRIG_OPERANDS_NUM = 5;
 
@@ -93,11 +100,16 @@ public:
     Disassembler(BrigContainer& c, EFloatDisassemblyMode fmode=FloatDisassemblyModeRawBits)
         : brig(c), err(0), stream(0), indent(0), hasErr(false),
           mModel(BRIG_MACHINE_LARGE), mProfile(BRIG_PROFILE_FULL),
-          m_options(fmode)
+          m_options(fmode), m_numThreads(1)
     {}
 
     void setOutputOptions(unsigned mask) { m_options = mask; }
 
+    /// disassemble large containers split at top-level statements on up
+    /// to numThreads threads. The output is identical to the serial one.
+    void setNumThreads(unsigned numThreads) { m_numThreads = numThreads; }
+
+    int run(OutputBuffer &out) const;     // Disassemble all BRIG container to buffer
     int run(std::ostream &s) const;       // Disassemble all BRIG container to stream
     int run(const char* path) const;      // Disassemble all BRIG container to file
 
@@ -125,6 +137,11 @@ public:
     // Directives
 private:
 
+    struct Partition;
+    int  runSerial(OutputBuffer &out) const;
+    int  runParallel(OutputBuffer &out) const;
+    void printPartition(Partition &p, int startIndent) const;
+
     void printDirectiveFmt(Code d) const;
     void printDirective(Directive d, bool dump = false) const;
 
@@ -347,10 +364,14 @@ private:
 
     template<class T>
     std::string getImpl(T d) const {
-        std::ostringstream os;
-        stream = &os;
-        if (d) printBrig(d);
-        return os.str();
+        std::string res;
+        {
+            OutputBuffer out(res);
+            stream = &out;
+            if (d) printBrig(d);
+        }
+        stream = 0;
+        return res;
     }
     void printBrig(Directive d) const { printDirective(d, true); }
     void printBrig(Inst i)      const { printInst(i); }
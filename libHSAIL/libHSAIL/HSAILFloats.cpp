@@ -130,26 +130,51 @@ f32_t f16_t::halfp2singles(uint16_t src)
     return makeFloat<f32_t>(f32signBit,exp,f32mntsBits);
 }
 
+static inline char* putHexDigits(char* p, uint64_t val, int numDigits)
+{
+    for(int i = numDigits; i-- > 0; val >>= 4) {
+        p[i] = "0123456789ABCDEF"[val & 0xF];
+    }
+    return p + numDigits;
+}
+
+static inline char* putDecimal(char* p, unsigned val)
+{
+    char digits[10];
+    int n = 0;
+    do { digits[n++] = static_cast<char>('0' + val % 10); val /= 10; } while (val);
+    while (n > 0) *p++ = digits[--n];
+    return p;
+}
+
+static inline char* putSuffix(char* p, const char* suffix)
+{
+    while (*suffix) *p++ = *suffix++;
+    return p;
+}
+
+// mantissa digits are printed with leading zeroes, terminal zero digits
+// are dropped (but at least one digit is printed)
 template <typename Float>
-std::string toC99str(Float v)
+size_t toC99chars(Float v, char* buf)
 {
     typedef IEEE754Traits<Float> Traits;
 
     typename Traits::RawBitsType const srcBits = v.rawBits();
-    std::ostringstream res;
+    char* p = buf;
 
     if (srcBits & Traits::signMask) {
-        res << "-";
+        *p++ = '-';
     }
 
     if( (srcBits & ~Traits::signMask) == 0 ) {
-        res << "0.0"  << Traits::suffix;
-        return res.str();
+        *p++ = '0'; *p++ = '.'; *p++ = '0';
+        return putSuffix(p, Traits::suffix) - buf;
     }
 
     const int mntsHDWidth = (Traits::mntsWidth/4) + ((Traits::mntsWidth%4)!=0 ? 1 : 0);
 
-    typename Traits::RawBitsType mntsBits = (srcBits & Traits::mntsMask) << (mntsHDWidth*4 - Traits::mntsWidth);
+    uint64_t mntsBits = static_cast<uint64_t>(srcBits & Traits::mntsMask) << (mntsHDWidth*4 - Traits::mntsWidth);
     int termZeroes = 0;
     if (mntsBits!=0) {
         while (!(mntsBits & 0xF)) {
@@ -159,15 +184,348 @@ std::string toC99str(Float v)
     } else termZeroes = mntsHDWidth-1;
 
     int const exp = static_cast<int>((srcBits & Traits::expMask) >> Traits::mntsWidth) - Traits::expBias;
-    if (exp==Traits::minExp) {
-        res << "0x0." << std::setw(mntsHDWidth-termZeroes);
+    *p++ = '0'; *p++ = 'x'; *p++ = exp==Traits::minExp ? '0' : '1'; *p++ = '.';
+    p = putHexDigits(p, mntsBits, mntsHDWidth-termZeroes);
+    *p++ = 'p';
+    if (exp < 0) *p++ = '-';
+    p = putDecimal(p, static_cast<unsigned>(exp < 0 ? -exp : exp));
+    return putSuffix(p, Traits::suffix) - buf;
+}
+
+template <typename Float>
+std::string toC99str(Float v)
+{
+    char buf[MAX_FLOAT_LITERAL_LEN];
+    return std::string(buf, toC99chars(v, buf));
+}
+
+//============================================================================
+// Shortest round-trip decimal output, following Ryu (Ulf Adams, "Ryu: fast
+// float-to-string conversion", PLDI 2018). The digits are computed with one
+// 64-bit core for all float types: f16 and f32 values are decomposed with
+// their own mantissa width and rounding of the scanner, so the interval of
+// decimals which read back as the value is the one of the narrow type. The
+// 125-bit multipliers for powers of 5 (and their inverses) are computed
+// once on first use instead of being spelled out as tables.
+
+namespace
+{
+
+enum {
+    POW5_BITCOUNT      = 125,
+    POW5_INV_BITCOUNT  = 125,
+    POW5_TABLE_SIZE    = 326,
+    POW5_INV_TABLE_SIZE = 342
+};
+
+// little-endian bignum large enough for 2^(pow5bits(342)+124)
+class BigUnsigned
+{
+    enum { NUM_WORDS = 32 };
+    uint32_t m_words[NUM_WORDS];
+
+public:
+    explicit BigUnsigned(uint32_t v = 0) { std::fill(m_words, m_words + NUM_WORDS, 0); m_words[0] = v; }
+
+    void setBit(int bit) { m_words[bit / 32] |= 1u << (bit % 32); }
+    bool bit(int bit) const { return bit >= 0 && bit < NUM_WORDS * 32 && ((m_words[bit / 32] >> (bit % 32)) & 1) != 0; }
+
+    int bitLength() const
+    {
+        for(int i = NUM_WORDS; i-- > 0;) {
+            for(int b = 32; b-- > 0;) {
+                if ((m_words[i] >> b) & 1) return i * 32 + b + 1;
+            }
+        }
+        return 0;
+    }
+
+    void mul(uint32_t m)
+    {
+        uint64_t carry = 0;
+        for(int i = 0; i < NUM_WORDS; ++i) {
+            carry += static_cast<uint64_t>(m_words[i]) * m;
+            m_words[i] = static_cast<uint32_t>(carry);
+            carry >>= 32;
+        }
+        assert(carry == 0);
+    }
+
+    void div(uint32_t d)
+    {
+        uint64_t rem = 0;
+        for(int i = NUM_WORDS; i-- > 0;) {
+            rem = (rem << 32) | m_words[i];
+            m_words[i] = static_cast<uint32_t>(rem / d);
+            rem %= d;
+        }
+    }
+
+    void inc()
+    {
+        for(int i = 0; i < NUM_WORDS && ++m_words[i] == 0; ++i) {}
+    }
+
+    // bits [shift, shift + 128) as two 64-bit words; shift may be negative
+    void get128(int shift, uint64_t res[2]) const
+    {
+        res[0] = res[1] = 0;
+        for(int b = 0; b < 128; ++b) {
+            if (bit(b + shift)) res[b / 64] |= uint64_t(1) << (b % 64);
+        }
+    }
+};
+
+struct Pow5Tables
+{
+    uint64_t split[POW5_TABLE_SIZE][2];        // 5^i, top POW5_BITCOUNT bits
+    uint64_t invSplit[POW5_INV_TABLE_SIZE][2]; // 2^(bitlength(5^i) - 1 + POW5_INV_BITCOUNT) / 5^i + 1
+
+    Pow5Tables()
+    {
+        BigUnsigned pow5(1);
+        for(int i = 0; i < POW5_TABLE_SIZE || i < POW5_INV_TABLE_SIZE; ++i, pow5.mul(5)) {
+            int const pow5len = pow5.bitLength();
+            if (i < POW5_TABLE_SIZE) {
+                pow5.get128(pow5len - POW5_BITCOUNT, split[i]);
+            }
+            if (i < POW5_INV_TABLE_SIZE) {
+                BigUnsigned inv;
+                inv.setBit(pow5len - 1 + POW5_INV_BITCOUNT);
+                int n = i;
+                for(; n >= 13; n -= 13) inv.div(1220703125u); // 5^13
+                uint32_t d = 1;
+                while (n-- > 0) d *= 5;
+                inv.div(d);
+                inv.inc();
+                inv.get128(0, invSplit[i]);
+            }
+        }
+    }
+};
+
+const Pow5Tables& pow5Tables()
+{
+    static const Pow5Tables tables;
+    return tables;
+}
+
+inline uint32_t pow5bits(int32_t e)  { return ((static_cast<uint32_t>(e) * 1217359) >> 19) + 1; }
+inline uint32_t log10Pow2(int32_t e) { return (static_cast<uint32_t>(e) * 78913) >> 18; }
+inline uint32_t log10Pow5(int32_t e) { return (static_cast<uint32_t>(e) * 732923) >> 20; }
+
+inline bool multipleOfPowerOf5(uint64_t value, uint32_t p)
+{
+    uint32_t count = 0;
+    for(; value % 5 == 0; value /= 5) ++count;
+    return count >= p;
+}
+
+inline bool multipleOfPowerOf2(uint64_t value, uint32_t p)
+{
+    return (value & ((uint64_t(1) << p) - 1)) == 0;
+}
+
+inline uint64_t umul128(uint64_t a, uint64_t b, uint64_t* hi)
+{
+    uint64_t const aLo = static_cast<uint32_t>(a), aHi = a >> 32;
+    uint64_t const bLo = static_cast<uint32_t>(b), bHi = b >> 32;
+    uint64_t const b00 = aLo * bLo, b01 = aLo * bHi, b10 = aHi * bLo, b11 = aHi * bHi;
+    uint64_t const mid1 = b10 + (b00 >> 32);
+    uint64_t const mid2 = b01 + static_cast<uint32_t>(mid1);
+    *hi = b11 + (mid1 >> 32) + (mid2 >> 32);
+    return (mid2 << 32) | static_cast<uint32_t>(b00);
+}
+
+// (m * mul) >> j, 64 < j < 128
+inline uint64_t mulShift(uint64_t m, const uint64_t mul[2], int32_t j)
+{
+    uint64_t high0, high1;
+    umul128(m, mul[0], &high0);
+    uint64_t const low1 = umul128(m, mul[1], &high1);
+    uint64_t const sum = high0 + low1;
+    if (sum < high0) ++high1;
+    int const dist = j - 64;
+    assert(dist > 0 && dist < 64);
+    return (high1 << (64 - dist)) | (sum >> dist);
+}
+
+// Shortest decimal digits * 10^exp10 in the rounding interval of the
+// positive finite value with the given IEEE fields. Ties between two values
+// are resolved to even, or away from zero if tiesAway is set.
+void shortestDecimal(uint64_t ieeeMantissa, uint32_t ieeeExponent, int mntsWidth, int expBias,
+                     bool tiesAway, uint64_t& digits, int32_t& exp10)
+{
+    int32_t e2;
+    uint64_t m2;
+    if (ieeeExponent == 0) {
+        e2 = 1 - expBias - mntsWidth - 2;
+        m2 = ieeeMantissa;
+    } else {
+        e2 = static_cast<int32_t>(ieeeExponent) - expBias - mntsWidth - 2;
+        m2 = (uint64_t(1) << mntsWidth) | ieeeMantissa;
+    }
+    // whether the bounds of the interval (the midpoints) round to this value
+    bool const acceptLower = tiesAway || (m2 & 1) == 0;
+    bool const acceptUpper = !tiesAway && (m2 & 1) == 0;
+
+    // the interval is [mv - 1 - mmShift, mv + 2] / 4 * 2^e2; the lower
+    // neighbour is closer at powers of 2
+    uint64_t const mv = 4 * m2;
+    uint32_t const mmShift = ieeeMantissa != 0 || ieeeExponent <= 1;
+
+    const Pow5Tables& tables = pow5Tables();
+    uint64_t vr, vp, vm;
+    int32_t e10;
+    bool vmIsTrailingZeros = false;
+    bool vrIsTrailingZeros = false;
+    if (e2 >= 0) {
+        uint32_t const q = log10Pow2(e2) - (e2 > 3);
+        e10 = static_cast<int32_t>(q);
+        int32_t const k = POW5_INV_BITCOUNT + static_cast<int32_t>(pow5bits(q)) - 1;
+        int32_t const i = -e2 + static_cast<int32_t>(q) + k;
+        assert(q < POW5_INV_TABLE_SIZE);
+        vr = mulShift(mv,                tables.invSplit[q], i);
+        vp = mulShift(mv + 2,            tables.invSplit[q], i);
+        vm = mulShift(mv - 1 - mmShift,  tables.invSplit[q], i);
+        if (q <= 21) {
+            // only one of mp, mv and mm can be a multiple of 5, if any
+            if (mv % 5 == 0) {
+                vrIsTrailingZeros = multipleOfPowerOf5(mv, q);
+            } else {
+                if (acceptLower) vmIsTrailingZeros = multipleOfPowerOf5(mv - 1 - mmShift, q);
+                if (!acceptUpper) vp -= multipleOfPowerOf5(mv + 2, q);
+            }
+        }
     } else {
-        res << "0x1." << std::setw(1);
+        uint32_t const q = log10Pow5(-e2) - (-e2 > 1);
+        e10 = static_cast<int32_t>(q) + e2;
+        int32_t const i = -e2 - static_cast<int32_t>(q);
+        int32_t const k = static_cast<int32_t>(pow5bits(i)) - POW5_BITCOUNT;
+        int32_t const j = static_cast<int32_t>(q) - k;
+        assert(i < POW5_TABLE_SIZE);
+        vr = mulShift(mv,                tables.split[i], j);
+        vp = mulShift(mv + 2,            tables.split[i], j);
+        vm = mulShift(mv - 1 - mmShift,  tables.split[i], j);
+        if (q <= 1) {
+            // mv has at least two trailing zero bits, mp at least one and
+            // mm one iff mmShift is 1
+            vrIsTrailingZeros = true;
+            if (acceptLower) vmIsTrailingZeros = mmShift == 1;
+            if (!acceptUpper) --vp;
+        } else if (q < 63) {
+            vrIsTrailingZeros = multipleOfPowerOf2(mv, q);
+        }
     }
 
-    res << std::setfill('0') << std::hex << std::uppercase << mntsBits << "p" << std::dec << std::setw(1) << exp << Traits::suffix;
+    // remove digits while the interval still contains a representation
+    int32_t removed = 0;
+    uint32_t lastRemovedDigit = 0;
+    uint64_t output;
+    if (vmIsTrailingZeros || vrIsTrailingZeros) {
+        for(;;) {
+            uint64_t const vpDiv10 = vp / 10;
+            uint64_t const vmDiv10 = vm / 10;
+            if (vpDiv10 <= vmDiv10) break;
+            uint64_t const vrDiv10 = vr / 10;
+            vmIsTrailingZeros &= vm - 10 * vmDiv10 == 0;
+            vrIsTrailingZeros &= lastRemovedDigit == 0;
+            lastRemovedDigit = static_cast<uint32_t>(vr - 10 * vrDiv10);
+            vr = vrDiv10; vp = vpDiv10; vm = vmDiv10;
+            ++removed;
+        }
+        if (vmIsTrailingZeros) {
+            for(;;) {
+                uint64_t const vmDiv10 = vm / 10;
+                if (vm - 10 * vmDiv10 != 0) break;
+                uint64_t const vrDiv10 = vr / 10;
+                vrIsTrailingZeros &= lastRemovedDigit == 0;
+                lastRemovedDigit = static_cast<uint32_t>(vr - 10 * vrDiv10);
+                vr = vrDiv10; vp = vp / 10; vm = vmDiv10;
+                ++removed;
+            }
+        }
+        if (vrIsTrailingZeros && lastRemovedDigit == 5 && vr % 2 == 0) {
+            lastRemovedDigit = 4; // exactly in the middle, round to even
+        }
+        output = vr + ((vr == vm && (!acceptLower || !vmIsTrailingZeros)) || lastRemovedDigit >= 5);
+    } else {
+        bool roundUp = false;
+        for(;;) {
+            uint64_t const vpDiv10 = vp / 10;
+            uint64_t const vmDiv10 = vm / 10;
+            if (vpDiv10 <= vmDiv10) break;
+            uint64_t const vrDiv10 = vr / 10;
+            roundUp = vr - 10 * vrDiv10 >= 5;
+            vr = vrDiv10; vp = vpDiv10; vm = vmDiv10;
+            ++removed;
+        }
+        output = vr + (vr == vm || roundUp);
+    }
+    digits = output;
+    exp10 = e10 + removed;
+}
+
+// Decimal literals are read as correctly rounded float or double; f16
+// literals are then converted from float by f16_t::singles2halfp which
+// rounds half away from zero.
+inline bool literalTiesAway(f16_t) { return true; }
+inline bool literalTiesAway(f32_t) { return false; }
+inline bool literalTiesAway(f64_t) { return false; }
+
+} // anonymous namespace
+
+// Plain notation for decimal exponents in [-5, 16), exponent notation for
+// the rest. A point is always printed so that the literal is a float one.
+template <typename Float>
+size_t toShortestDecimal(Float v, char* buf)
+{
+    typedef IEEE754Traits<Float> Traits;
+
+    typename Traits::RawBitsType const srcBits = v.rawBits();
+    assert((srcBits & Traits::expMask) != Traits::expMask);
+    char* p = buf;
+
+    if (srcBits & Traits::signMask) {
+        *p++ = '-';
+    }
+
+    if( (srcBits & ~Traits::signMask) == 0 ) {
+        *p++ = '0'; *p++ = '.'; *p++ = '0';
+        return putSuffix(p, Traits::suffix) - buf;
+    }
+
+    uint64_t output;
+    int32_t exp10;
+    shortestDecimal(srcBits & Traits::mntsMask, static_cast<uint32_t>((srcBits & Traits::expMask) >> Traits::mntsWidth),
+                    Traits::mntsWidth, Traits::expBias, literalTiesAway(v), output, exp10);
 
-    return res.str();
+    char digits[20];
+    int n = 0;
+    for(uint64_t d = output; d != 0; d /= 10) {
+        digits[n++] = static_cast<char>('0' + d % 10);
+    }
+    std::reverse(digits, digits + n);
+    int const exp = exp10 + n - 1; // of the first digit
+
+    if (exp >= 0 && exp < 16) {
+        for(int i = 0; i <= exp; ++i) *p++ = i < n ? digits[i] : '0';
+        *p++ = '.';
+        if (n <= exp + 1) *p++ = '0';
+        for(int i = exp + 1; i < n; ++i) *p++ = digits[i];
+    } else if (exp < 0 && exp >= -5) {
+        *p++ = '0'; *p++ = '.';
+        for(int i = -1; i > exp; --i) *p++ = '0';
+        for(int i = 0; i < n; ++i) *p++ = digits[i];
+    } else {
+        *p++ = digits[0]; *p++ = '.';
+        if (n == 1) *p++ = '0';
+        for(int i = 1; i < n; ++i) *p++ = digits[i];
+        *p++ = 'e';
+        if (exp < 0) *p++ = '-';
+        p = putDecimal(p, static_cast<unsigned>(exp < 0 ? -exp : exp));
+    }
+    return putSuffix(p, Traits::suffix) - buf;
 }
 
 static inline int digitValue(int c)
@@ -256,7 +614,12 @@ Float readC99(const SRef& s)
             while (tolower(*p)!='p') ++p; // skip the rest of digits until 'p'
 
             ++p;
-            std::istrstream(p,end-p) >> std::dec >> exp;  // read decimal exponent
+            bool const negExp = (*p == '-'); // read decimal exponent
+            if (*p == '-' || *p == '+') ++p;
+            for(; p != end && *p >= '0' && *p <= '9'; ++p) {
+                if (exp < 100000) exp = exp * 10 + (*p - '0'); // saturate, out of range anyway
+            }
+            if (negExp) exp = -exp;
             exp += expShift - 1;
 
             if (bitCount > maxBits) {
@@ -372,6 +735,14 @@ template std::string toC99str(f16_t v);
 template std::string toC99str(f32_t v);
 template std::string toC99str(f64_t v);
 
+template size_t toC99chars(f16_t v, char* buf);
+template size_t toC99chars(f32_t v, char* buf);
+template size_t toC99chars(f64_t v, char* buf);
+
+template size_t toShortestDecimal(f16_t v, char* buf);
+template size_t toShortestDecimal(f32_t v, char* buf);
+template size_t toShortestDecimal(f64_t v, char* buf);
+
 template f16_t  readC99(const SRef& s);
 template f32_t  readC99(const SRef& s);
 template f64_t  readC99(const SRef& s);
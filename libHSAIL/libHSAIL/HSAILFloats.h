@@ -190,6 +190,20 @@ template <> struct value_class<f16_t>  : float_class {};
 template <typename Float>
 std::string toC99str(Float v);
 
+// Upper bound of the length of literals written by toC99chars and
+// toShortestDecimal, including the type suffix
+enum { MAX_FLOAT_LITERAL_LEN = 32 };
+
+// Same as toC99str, written to buf; returns the length (no terminating zero)
+template <typename Float>
+size_t toC99chars(Float v, char* buf);
+
+// Shortest decimal literal (with type suffix) which the scanner reads back
+// as exactly v, written to buf; returns the length (no terminating zero).
+// v must be finite.
+template <typename Float>
+size_t toShortestDecimal(Float v, char* buf);
+
 struct SRef;
 
 template <typename Float>
@@ -0,0 +1,441 @@
+// University of Illinois/NCSA
+// Open Source License
+//
+// Copyright (c) 2013-2015, Advanced Micro Devices, Inc.
+// All rights reserved.
+//
+// Developed by:
+//
+//     HSA Team
+//
+//     Advanced Micro Devices, Inc
+//
+//     www.amd.com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the "Software"), to deal with
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+//     * Redistributions of source code must retain the above copyright notice,
+//       this list of conditions and the following disclaimers.
+//
+//     * Redistributions in binary form must reproduce the above copyright notice,
+//       this list of conditions and the following disclaimers in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the names of the LLVM Team, University of Illinois at
+//       Urbana-Champaign, nor the names of its contributors may be used to
+//       endorse or promote products derived from this Software without specific
+//       prior written permission.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS WITH THE
+// SOFTWARE.
+#include "HSAILParser.h"
+#include "HSAILItems.h"
+
+#include <algorithm>
+#include <map>
+#include <string>
+#include <sstream>
+#include <vector>
+
+namespace HSAIL_ASM
+{
+
+namespace {
+
+uint64_t hashText(const char* p, size_t n)
+{
+    uint64_t h = 14695981039346656037ULL; // FNV-1a
+    for(size_t i = 0; i < n; ++i) {
+        h ^= (unsigned char)p[i];
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+int columnAt(const std::string& text, size_t ofs)
+{
+    size_t const nl = ofs==0 ? std::string::npos : text.rfind('\n', ofs - 1);
+    return (int)(nl==std::string::npos ? ofs : ofs - nl - 1);
+}
+
+// module scope symbols declared by the top-level statements in [begin,end),
+// false if a module statement is among them
+bool collectModuleScope(CodeSection& code, Offset begin, Offset end, std::vector<Directive>& syms)
+{
+    for(Code c(&code, begin); c.brigOffset() < end; ) {
+        if (DirectiveExecutable d = c) {
+            syms.push_back(d);
+            c = d.nextModuleEntry();
+            continue;
+        }
+        if (DirectiveModule(c)) {
+            return false;
+        }
+        if (DirectiveVariable d = c) {
+            if (isGlobalName(d.name())) syms.push_back(d);
+        } else if (DirectiveFbarrier d = c) {
+            if (isGlobalName(d.name())) syms.push_back(d);
+        }
+        c = c.next();
+    }
+    return true;
+}
+
+template <typename Dir>
+bool sameSymbol(Dir a, Dir b)
+{
+    SRef const aName = a.name(), bName = b.name();
+    return aName==bName &&
+        a.linkage()==b.linkage() &&
+        a.modifier().isDefinition()==b.modifier().isDefinition();
+}
+
+bool sameSymbol(Directive a, Directive b)
+{
+    if (a.kind()!=b.kind()) return false;
+    if (DirectiveExecutable d = a) return sameSymbol(d, DirectiveExecutable(b));
+    if (DirectiveVariable d = a) return sameSymbol(d, DirectiveVariable(b));
+    return sameSymbol(DirectiveFbarrier(a), DirectiveFbarrier(b));
+}
+
+// true if the statements replacing [begin,end) of the code section with the
+// ones in [from,size) declare the same module scope symbols. Maps the old
+// symbols to the offsets of the new ones after the splice.
+bool sameModuleScope(CodeSection& code, Offset begin, Offset end, Offset from, Offset size,
+                     std::map<Offset,Offset>& symbols)
+{
+    std::vector<Directive> oldSyms, newSyms;
+    if (!collectModuleScope(code, begin, end, oldSyms) ||
+        !collectModuleScope(code, from, size, newSyms) ||
+        oldSyms.size()!=newSyms.size()) {
+        return false;
+    }
+    for(size_t i = 0; i < oldSyms.size(); ++i) {
+        if (!sameSymbol(oldSyms[i], newSyms[i])) return false;
+        symbols[oldSyms[i].brigOffset()] = newSyms[i].brigOffset() - from + begin;
+    }
+    return true;
+}
+
+// removes the items and strings appended from the specified offsets on
+void dropTail(BrigContainer& c, Offset code, Offset operand, Offset data)
+{
+    c.code().spliceTail(code, c.code().size(), c.code().size());
+    c.operands().spliceTail(operand, c.operands().size(), c.operands().size());
+    c.strings().truncate(data);
+}
+
+// Fixes up item offsets for the replacement of the items in [begin,end) of
+// the code and operand sections with the new ones appended at the section
+// ends from 'from' on. Offsets are computed for the layout after the splice.
+// Code offsets inside the replaced range are only valid as the boundary of
+// the previous statement or, from operands, as a module scope symbol which
+// has a counterpart among the new items. The new offsets are collected and
+// only written by apply(), so nothing changes if one of them is invalid.
+class SpliceRelocator
+{
+public:
+    struct Range
+    {
+        Offset begin, end, from, size;
+    };
+
+    SpliceRelocator(const Range* ranges, const std::map<Offset,Offset>& symbols)
+        : m_ranges(ranges), m_symbols(symbols), m_failed(false) {}
+
+    template <typename Item>
+    void relocItems(BrigSectionImpl& s, Offset begin, Offset end, bool ofNew) {
+        m_ofNew = ofNew;
+        m_ofOperand = (int)Item::SECTION==BRIG_SECTION_INDEX_OPERAND;
+        for(Item i(&s, begin); i.brigOffset() < end; i = i.next()) {
+            enumerateFields(i, *this);
+        }
+    }
+
+    bool failed() const { return m_failed; }
+
+    void apply() const {
+        assert(!m_failed);
+        for(size_t i = 0; i < m_fixups.size(); ++i) {
+            *m_fixups[i].first = m_fixups[i].second;
+        }
+    }
+
+    template <typename I>
+    void operator()(ItemRef<I> ref, ...) { reloc(I::SECTION, ref.deref()); }
+
+    template <typename I>
+    void operator()(ListRef<I> list, ...) {
+        for(int i = 0, size = list.size(); i < size; ++i) {
+            reloc(I::SECTION, list.writeAccess(i).deref());
+        }
+    }
+
+    template <typename T>
+    void operator()(const T&, ...) {} // all others
+
+private:
+    const Range*                   m_ranges;
+    const std::map<Offset,Offset>& m_symbols;
+    bool                           m_ofNew;
+    bool                           m_ofOperand;
+    bool                           m_failed;
+    std::vector< std::pair<Offset*,Offset> > m_fixups;
+
+    void reloc(int section, Offset& ofs);
+    void fixup(Offset& ofs, Offset value) { m_fixups.push_back(std::make_pair(&ofs, value)); }
+};
+
+void SpliceRelocator::reloc(int section, Offset& ofs)
+{
+    if (ofs==0 || section==BRIG_SECTION_INDEX_DATA) return;
+    Range const& r = m_ranges[section];
+    if (m_ofNew) {
+        if (ofs >= r.from) {
+            fixup(ofs, ofs - r.from + r.begin);
+        } else if (ofs >= r.begin) {
+            m_failed = true; // the new items see only what precedes them
+        }
+        return;
+    }
+    bool const symbol = section==BRIG_SECTION_INDEX_CODE && m_ofOperand;
+    if (ofs < r.begin || (ofs==r.begin && section==BRIG_SECTION_INDEX_CODE && !symbol)) return;
+    if (ofs >= r.end) {
+        fixup(ofs, ofs - r.end + r.begin + (r.size - r.from));
+        return;
+    }
+    if (symbol) {
+        std::map<Offset,Offset>::const_iterator const s = m_symbols.find(ofs);
+        if (s!=m_symbols.end()) {
+            fixup(ofs, s->second);
+            return;
+        }
+    }
+    m_failed = true;
+}
+
+template <typename Item>
+void shiftSourceInfo(BrigSectionImpl& s, Offset begin, int line, int lineDelta, int columnDelta)
+{
+    for(Item i(&s, begin); i.brigOffset() < s.size(); i = i.next()) {
+        if (const SourceInfo* si = s.sourceInfo(i)) {
+            SourceInfo moved = *si;
+            if (moved.line==line) moved.column += columnDelta;
+            moved.line += lineDelta;
+            s.annotate(i, moved);
+        }
+    }
+}
+
+} // namespace
+
+IncrementalParser::IncrementalParser(BrigContainer& container, bool disableComments)
+    : m_container(container)
+    , m_disableComments(disableComments)
+    , m_numParsed(0)
+{
+}
+
+void IncrementalParser::parse(const std::string& text)
+{
+    std::vector<Segment> segs;
+    TopLevelSplitter splitter(text.data(), text.data() + text.size(), false);
+    if (splitter.split()) {
+        splitter.stmtEnds.push_back(text.size()); // whatever follows the last statement
+        size_t begin = 0;
+        for(size_t i = 0; i < splitter.stmtEnds.size(); ++i) {
+            Segment seg;
+            seg.begin = begin;
+            seg.end = splitter.stmtEnds[i];
+            seg.hash = hashText(text.data() + seg.begin, seg.end - seg.begin);
+            segs.push_back(seg);
+            begin = seg.end;
+        }
+    } else {
+        // the whole text is parsed each time, let the parser report errors
+        Segment seg;
+        seg.begin = 0;
+        seg.end = text.size();
+        seg.hash = 0;
+        segs.push_back(seg);
+    }
+
+    if (segs.size() < 2 || m_segments.empty() || !update(text, segs)) {
+        parseAll(text, segs);
+    }
+}
+
+void IncrementalParser::parseAll(const std::string& text, std::vector<Segment>& segs)
+{
+    m_segments.clear();
+    m_text.clear();
+    m_container.clear();
+
+    std::istringstream is(text);
+    Scanner scanner(is, m_disableComments);
+    Parser parser(scanner, m_container);
+    parser.m_bw.startProgram();
+    parser.m_gcnEnabled = false;
+    parseSegments(parser, 0, &segs[0], &segs[0] + segs.size());
+    parser.m_bw.endProgram();
+
+    m_segments.swap(segs);
+    m_text = text;
+    m_numParsed = m_segments.size();
+}
+
+// Parses the statements of segments [seg,end), recording where their items
+// start and the parser state after them. The scanner text corresponds to the
+// text of the segments, shift is the offset of its first char in the module.
+void IncrementalParser::parseSegments(Parser& parser, ptrdiff_t shift, Segment* seg, Segment* end)
+{
+    const char* const base = parser.m_scanner.getPlainText().begin;
+    for(; seg != end; ++seg) {
+        seg->code = m_container.code().size();
+        seg->operand = m_container.operands().size();
+        while (parser.peek().kind()!=EEndOfSource &&
+               (parser.peek().text().begin - base) + shift < (ptrdiff_t)seg->end) {
+            parser.parseTopLevelStatement();
+        }
+        seg->gcnEnabled = parser.m_gcnEnabled;
+        seg->srcFileName = parser.m_srcFileName;
+    }
+}
+
+bool IncrementalParser::update(const std::string& text, std::vector<Segment>& segs)
+{
+    std::vector<Segment>& old = m_segments;
+    size_t const oldNum = old.size(), newNum = segs.size();
+    struct Same {
+        const std::string& oldText;
+        const std::string& newText;
+        bool operator()(const Segment& o, const Segment& n) const {
+            return o.hash==n.hash && o.end - o.begin==n.end - n.begin &&
+                oldText.compare(o.begin, o.end - o.begin, newText, n.begin, n.end - n.begin)==0;
+        }
+    } const same = { m_text, text };
+
+    size_t first = 0, tail = 0;
+    while (first < oldNum && first < newNum && same(old[first], segs[first])) ++first;
+    while (tail < oldNum - first && tail < newNum - first &&
+           same(old[oldNum - 1 - tail], segs[newNum - 1 - tail])) ++tail;
+    if (first==0) return false; // the module statement comes first
+    size_t const oldLast = oldNum - tail, newLast = newNum - tail;
+    if (oldLast==first && newLast==first) {
+        m_numParsed = 0;
+        return true;
+    }
+
+    CodeSection& code = m_container.code();
+    OperandSection& operands = m_container.operands();
+    SpliceRelocator::Range ranges[BRIG_SECTION_INDEX_IMPLEMENTATION_DEFINED] = {};
+    SpliceRelocator::Range& rc = ranges[BRIG_SECTION_INDEX_CODE];
+    SpliceRelocator::Range& ro = ranges[BRIG_SECTION_INDEX_OPERAND];
+    rc.begin = first < oldNum ? old[first].code : code.size();
+    rc.end = oldLast < oldNum ? old[oldLast].code : code.size();
+    rc.from = code.size();
+    ro.begin = first < oldNum ? old[first].operand : operands.size();
+    ro.end = oldLast < oldNum ? old[oldLast].operand : operands.size();
+    ro.from = operands.size();
+    Offset const dataFrom = m_container.strings().size();
+
+    // parse the changed statements at their original lines and columns
+    // appending the items to the sections
+    size_t const runBegin = segs[first - 1].end, runEnd = segs[newLast - 1].end;
+    size_t const oldRunEnd = old[oldLast - 1].end;
+    int const line = (int)std::count(text.begin(), text.begin() + runBegin, '\n');
+    Segment const& prev = old[first - 1];
+    if (newLast > first) {
+        std::string src(line, '\n');
+        src.append(columnAt(text, runBegin), ' ');
+        ptrdiff_t const shift = (ptrdiff_t)runBegin - (ptrdiff_t)src.size();
+        src.append(text, runBegin, runEnd - runBegin);
+
+        std::istringstream is(src);
+        Scanner scanner(is, m_disableComments);
+        Parser parser(scanner, m_container);
+        parser.m_bw.resumeProgram(rc.begin);
+        parser.m_gcnEnabled = prev.gcnEnabled;
+        parser.m_srcFileName = prev.srcFileName;
+        try {
+            parseSegments(parser, shift, &segs[first], &segs[0] + newLast);
+        } catch (const SyntaxError&) {
+            dropTail(m_container, rc.from, ro.from, dataFrom);
+            throw;
+        }
+    }
+    rc.size = code.size();
+    ro.size = operands.size();
+
+    // the rest of the module must be parsed the same way as before and all
+    // the offsets must be relocatable, otherwise the container is restored
+    Segment const& oldEnd = old[oldLast - 1];
+    Segment const& newEnd = newLast > first ? segs[newLast - 1] : prev;
+    std::map<Offset,Offset> symbols;
+    SpliceRelocator relocator(ranges, symbols);
+    bool splice = newEnd.gcnEnabled==oldEnd.gcnEnabled && newEnd.srcFileName==oldEnd.srcFileName &&
+                  sameModuleScope(code, rc.begin, rc.end, rc.from, rc.size, symbols);
+    if (splice) {
+        relocator.relocItems<Code>(code, code.begin().brigOffset(), rc.begin, false);
+        relocator.relocItems<Code>(code, rc.end, rc.from, false);
+        relocator.relocItems<Code>(code, rc.from, rc.size, true);
+        relocator.relocItems<Operand>(operands, operands.begin().brigOffset(), ro.begin, false);
+        relocator.relocItems<Operand>(operands, ro.end, ro.from, false);
+        relocator.relocItems<Operand>(operands, ro.from, ro.size, true);
+        splice = !relocator.failed();
+    }
+    if (!splice) {
+        dropTail(m_container, rc.from, ro.from, dataFrom);
+        return false;
+    }
+    relocator.apply();
+
+    code.spliceTail(rc.begin, rc.end, rc.from);
+    operands.spliceTail(ro.begin, ro.end, ro.from);
+
+    // move the source positions of the following statements
+    int const oldEndLine = line + (int)std::count(m_text.begin() + runBegin, m_text.begin() + oldRunEnd, '\n');
+    int const newEndLine = line + (int)std::count(text.begin() + runBegin, text.begin() + runEnd, '\n');
+    int const columnDelta = columnAt(text, runEnd) - columnAt(m_text, oldRunEnd);
+    if (newEndLine!=oldEndLine || columnDelta!=0) {
+        shiftSourceInfo<Code>(code, rc.begin + (rc.size - rc.from), oldEndLine, newEndLine - oldEndLine, columnDelta);
+        shiftSourceInfo<Operand>(operands, ro.begin + (ro.size - ro.from), oldEndLine, newEndLine - oldEndLine, columnDelta);
+    }
+
+    for(size_t i = 0; i < first; ++i) {
+        segs[i].code = old[i].code;
+        segs[i].operand = old[i].operand;
+        segs[i].gcnEnabled = old[i].gcnEnabled;
+        segs[i].srcFileName.swap(old[i].srcFileName);
+    }
+    for(size_t i = first; i < newLast; ++i) {
+        segs[i].code = segs[i].code - rc.from + rc.begin;
+        segs[i].operand = segs[i].operand - ro.from + ro.begin;
+    }
+    for(size_t i = 0; i < tail; ++i) {
+        Segment& seg = segs[newLast + i];
+        Segment& o = old[oldLast + i];
+        seg.code = o.code - rc.end + rc.begin + (rc.size - rc.from);
+        seg.operand = o.operand - ro.end + ro.begin + (ro.size - ro.from);
+        seg.gcnEnabled = o.gcnEnabled;
+        seg.srcFileName.swap(o.srcFileName);
+    }
+    m_segments.swap(segs);
+    m_text = text;
+    m_numParsed = newLast - first;
+
+    m_container.patchDecl2Defs();
+    return true;
+}
+
+} // namespace HSAIL_ASM
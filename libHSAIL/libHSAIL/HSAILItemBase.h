@@ -60,11 +60,35 @@ class ItemBase;
 template <typename Dst, typename Src> struct copy_const { typedef Dst type; };
 template <typename Dst, typename Src> struct copy_const<Dst, const Src> { typedef const Dst type; };
 
+/// bytes of immediates and aggregates. Typical immediates are kept inline,
+/// larger data goes to the heap.
 class ArbitraryData
 {
-    std::vector<char> m_buffer;
+    enum { INLINE_SIZE = 16 };
+
+    char              m_inline[INLINE_SIZE];
+    size_t            m_size;
+    std::vector<char> m_spill; // all the data once it doesn't fit inline
+
+    const char* bytes() const { return m_spill.empty() ? m_inline : &m_spill[0]; }
+    char* bytes() { return m_spill.empty() ? m_inline : &m_spill[0]; }
+
+    void resize(size_t size) {
+        if (size > INLINE_SIZE || !m_spill.empty()) {
+            if (m_spill.empty()) {
+                m_spill.assign(m_inline, m_inline + m_size);
+            }
+            m_spill.resize(size);
+        } else if (size > m_size) {
+            memset(m_inline + m_size, 0, size - m_size);
+        }
+        m_size = size;
+    }
+
 public:
-    SRef toSRef() const { return m_buffer.empty() ? SRef() : SRef(&m_buffer[0],&m_buffer[0]+m_buffer.size()); }
+    ArbitraryData() : m_size(0) {}
+
+    SRef toSRef() const { return m_size==0 ? SRef() : SRef(bytes(),bytes()+m_size); }
 
     template<typename T>
     void push_back(T t) {
@@ -72,7 +96,7 @@ public:
     }
 
     void push_zeroes(size_t count) {
-        m_buffer.resize(m_buffer.size() + count);
+        resize(m_size + count);
     }
 
     template<typename T>
@@ -86,17 +110,16 @@ public:
 
     void write(const void* p, unsigned n, size_t pos) {
         if (numBytes() < pos + n) {
-            m_buffer.resize(pos + n);
+            resize(pos + n);
         }
-        memcpy(&m_buffer[pos], p, n);
+        memcpy(bytes() + pos, p, n);
     }
 
     void alignBack(unsigned a) {
-        for(unsigned s = m_buffer.size() % a; s > 0; --s)
-          m_buffer.push_back(0);
+        push_zeroes(m_size % a);
     }
 
-    size_t numBytes() const { return m_buffer.size(); }
+    size_t numBytes() const { return m_size; }
 };
 
 
@@ -339,31 +362,33 @@ public:
 
 class ItemList
 {
+    enum { INLINE_SIZE = 5 }; // operands of an instruction
 
     BrigSectionImpl*    m_section;
-    // \todo1.0!!!
-    std::vector<Offset> m_offsets;
+    Offset              m_inline[INLINE_SIZE];
+    unsigned            m_size;
+    std::vector<Offset> m_spill; // all the offsets once they don't fit inline
 
 public:
-    ItemList() : m_section(0), m_offsets() { }
+    ItemList() : m_section(0), m_size(0) { }
 
     /// number of items in the range.
-    unsigned size() const { return (unsigned) m_offsets.size(); }
+    unsigned size() const { return m_size; }
 
-    void clear() { m_section = 0; m_offsets.clear(); }
+    void clear() { m_section = 0; m_size = 0; m_spill.clear(); }
 
     ItemBase operator[](int index)  const;
 
     BrigSectionImpl* section() { return m_section; }
     const BrigSectionImpl* section() const { return m_section; }
-    const std::vector<Offset>& offsets() const { return m_offsets; }
-    bool empty() const { return m_offsets.empty(); }
+    const Offset* offsets() const { return m_spill.empty() ? m_inline : &m_spill[0]; }
+    bool empty() const { return m_size==0; }
     SRef data() const {
-        if (m_offsets.empty()) {
+        if (m_size==0) {
             return SRef();
         } else {
-            const char* dataPtr = (char*)&m_offsets[0];
-            return SRef(dataPtr, dataPtr + sizeof(unsigned) * m_offsets.size());
+            const char* dataPtr = (const char*)offsets();
+            return SRef(dataPtr, dataPtr + sizeof(Offset) * m_size);
         }
     }
 
@@ -625,16 +650,24 @@ public:
   ItemIterator operator++(int) { ItemIterator it = *this; ++(*this); return it; }
 };
 
-    inline ItemBase ItemList::operator[](int index)  const { return ItemBase(m_section, m_offsets[index]); }
+    inline ItemBase ItemList::operator[](int index)  const { return ItemBase(m_section, offsets()[index]); }
 
     inline void ItemList::push_back(const ItemBase& i) {
-      if (m_offsets.empty()) {
+      if (m_size==0) {
         assert(m_section == 0);
         m_section = i.section();
       } else {
         assert(m_section == i.section());
       }
-      m_offsets.push_back(i.brigOffset());
+      if (m_size < INLINE_SIZE) {
+        m_inline[m_size] = i.brigOffset();
+      } else {
+        if (m_spill.empty()) {
+          m_spill.assign(m_inline, m_inline + m_size);
+        }
+        m_spill.push_back(i.brigOffset());
+      }
+      ++m_size;
     }
 
 
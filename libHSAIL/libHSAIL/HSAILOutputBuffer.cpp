@@ -0,0 +1,180 @@
+// University of Illinois/NCSA
+// Open Source License
+//
+// Copyright (c) 2013-2015, Advanced Micro Devices, Inc.
+// All rights reserved.
+//
+// Developed by:
+//
+//     HSA Team
+//
+//     Advanced Micro Devices, Inc
+//
+//     www.amd.com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the "Software"), to deal with
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+//     * Redistributions of source code must retain the above copyright notice,
+//       this list of conditions and the following disclaimers.
+//
+//     * Redistributions in binary form must reproduce the above copyright notice,
+//       this list of conditions and the following disclaimers in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the names of the LLVM Team, University of Illinois at
+//       Urbana-Champaign, nor the names of its contributors may be used to
+//       endorse or promote products derived from this Software without specific
+//       prior written permission.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS WITH THE
+// SOFTWARE.
+#include "HSAILOutputBuffer.h"
+
+#include <cassert>
+#include <ostream>
+
+namespace HSAIL_ASM
+{
+
+namespace {
+
+const char DIGIT_PAIRS[] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+const char HEX_DIGITS[] = "0123456789abcdef";
+
+} // noname namespace
+
+OutputBuffer::OutputBuffer(std::string& s)
+    : m_string(&s), m_file(NULL), m_stream(NULL), m_failed(false)
+{
+    init(STRING_BLOCK_SIZE);
+}
+
+OutputBuffer::OutputBuffer(FILE* f)
+    : m_string(NULL), m_file(f), m_stream(NULL), m_failed(false)
+{
+    assert(f);
+    init(FILE_BLOCK_SIZE);
+}
+
+OutputBuffer::OutputBuffer(std::ostream& os)
+    : m_string(NULL), m_file(NULL), m_stream(&os), m_failed(false)
+{
+    init(FILE_BLOCK_SIZE);
+}
+
+void OutputBuffer::init(size_t blockSize)
+{
+    m_block.reset(new char[blockSize]);
+    m_pos = m_block.get();
+    m_end = m_pos + blockSize;
+}
+
+void OutputBuffer::flush()
+{
+    size_t const n = m_pos - m_block.get();
+    m_pos = m_block.get();
+    if (n == 0) return;
+
+    if (m_string) {
+        m_string->append(m_block.get(), n);
+    } else if (m_file) {
+        m_failed |= fwrite(m_block.get(), 1, n, m_file) != n;
+    } else {
+        m_failed |= !m_stream->write(m_block.get(), n);
+    }
+}
+
+void OutputBuffer::writeLong(const char* s, size_t n)
+{
+    size_t const room = m_end - m_pos;
+    memcpy(m_pos, s, room);
+    m_pos += room;
+    s += room;
+    n -= room;
+    flush();
+
+    // longer than a block: bypass the buffer
+    if (n >= (size_t)(m_end - m_pos)) {
+        if (m_string) {
+            m_string->append(s, n);
+        } else if (m_file) {
+            m_failed |= fwrite(s, 1, n, m_file) != n;
+        } else {
+            m_failed |= !m_stream->write(s, n);
+        }
+        return;
+    }
+    memcpy(m_pos, s, n);
+    m_pos += n;
+}
+
+void OutputBuffer::putUnsigned(uint64_t val)
+{
+    char buf[20];
+    char* p = buf + sizeof(buf);
+    while (val >= 100) {
+        unsigned const pair = (unsigned)(val % 100) * 2;
+        val /= 100;
+        *--p = DIGIT_PAIRS[pair + 1];
+        *--p = DIGIT_PAIRS[pair];
+    }
+    if (val >= 10) {
+        *--p = DIGIT_PAIRS[val * 2 + 1];
+        *--p = DIGIT_PAIRS[val * 2];
+    } else {
+        *--p = (char)('0' + val);
+    }
+    write(p, buf + sizeof(buf) - p);
+}
+
+void OutputBuffer::putSigned(int64_t val)
+{
+    if (val < 0) {
+        put('-');
+        putUnsigned(0 - (uint64_t)val);
+    } else {
+        putUnsigned((uint64_t)val);
+    }
+}
+
+void OutputBuffer::putHex(const void* data, size_t numBytes)
+{
+    const uint8_t* const bytes = static_cast<const uint8_t*>(data);
+    if ((size_t)(m_end - m_pos) < 2 * numBytes) {
+        flush();
+        if ((size_t)(m_end - m_pos) < 2 * numBytes) {
+            for (size_t i = numBytes; i-- > 0; ) {
+                put(HEX_DIGITS[bytes[i] >> 4]);
+                put(HEX_DIGITS[bytes[i] & 0xF]);
+            }
+            return;
+        }
+    }
+    for (size_t i = numBytes; i-- > 0; ) {
+        *m_pos++ = HEX_DIGITS[bytes[i] >> 4];
+        *m_pos++ = HEX_DIGITS[bytes[i] & 0xF];
+    }
+}
+
+}
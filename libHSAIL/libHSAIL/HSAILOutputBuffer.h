@@ -0,0 +1,139 @@
+// University of Illinois/NCSA
+// Open Source License
+//
+// Copyright (c) 2013-2015, Advanced Micro Devices, Inc.
+// All rights reserved.
+//
+// Developed by:
+//
+//     HSA Team
+//
+//     Advanced Micro Devices, Inc
+//
+//     www.amd.com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the "Software"), to deal with
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+//     * Redistributions of source code must retain the above copyright notice,
+//       this list of conditions and the following disclaimers.
+//
+//     * Redistributions in binary form must reproduce the above copyright notice,
+//       this list of conditions and the following disclaimers in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the names of the LLVM Team, University of Illinois at
+//       Urbana-Champaign, nor the names of its contributors may be used to
+//       endorse or promote products derived from this Software without specific
+//       prior written permission.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS WITH THE
+// SOFTWARE.
+#pragma once
+#ifndef INCLUDED_HSAIL_OUTPUT_BUFFER_H
+#define INCLUDED_HSAIL_OUTPUT_BUFFER_H
+
+#include "HSAILSRef.h"
+
+#include <cstdio>
+#include <cstring>
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <stdint.h>
+
+namespace HSAIL_ASM
+{
+
+/// Append-only text buffer which the Disassembler prints to. Integers and
+/// hex digits are formatted directly into the buffer, without locale or
+/// stream state, and the text is passed on to the destination (a string,
+/// a file or a std::ostream) in blocks. Whatever is left in the buffer is
+/// passed on by flush() and by the destructor.
+///
+/// Values are printed as a std::ostream with the default format would
+/// print them, so that the buffer can replace one: in particular, chars
+/// are printed as characters and bools as 0 or 1.
+class OutputBuffer
+{
+    std::unique_ptr<char[]> m_block;
+    char*                   m_pos;
+    char*                   m_end;
+
+    std::string*            m_string;  // the destination is one of these
+    FILE*                   m_file;
+    std::ostream*           m_stream;
+    bool                    m_failed;
+
+    OutputBuffer(const OutputBuffer&); // non-copyable
+    const OutputBuffer &operator=(const OutputBuffer &); // not assignable
+
+    void init(size_t blockSize);
+    void writeLong(const char* s, size_t n);
+    void putUnsigned(uint64_t val);
+    void putSigned(int64_t val);
+
+public:
+    enum { FILE_BLOCK_SIZE = 64 * 1024, STRING_BLOCK_SIZE = 1024 };
+
+    explicit OutputBuffer(std::string& s);
+    explicit OutputBuffer(FILE* f);
+    explicit OutputBuffer(std::ostream& os);
+    ~OutputBuffer() { flush(); }
+
+    /// passes the buffered text to the destination
+    void flush();
+
+    /// whether writing to the destination has failed
+    bool failed() const { return m_failed; }
+
+    void put(char c)
+    {
+        if (m_pos == m_end) flush();
+        *m_pos++ = c;
+    }
+
+    void write(const char* s, size_t n)
+    {
+        if (n <= (size_t)(m_end - m_pos)) {
+            memcpy(m_pos, s, n);
+            m_pos += n;
+        } else {
+            writeLong(s, n);
+        }
+    }
+
+    /// bytes of the value as hex digits, the most significant first
+    /// (bytes are in little-endian order)
+    void putHex(const void* data, size_t numBytes);
+
+    OutputBuffer& operator<<(char c)               { put(c); return *this; }
+    OutputBuffer& operator<<(signed char c)        { put((char)c); return *this; }
+    OutputBuffer& operator<<(unsigned char c)      { put((char)c); return *this; }
+    OutputBuffer& operator<<(const char* s)        { write(s, strlen(s)); return *this; }
+    OutputBuffer& operator<<(const std::string& s) { write(s.data(), s.size()); return *this; }
+    OutputBuffer& operator<<(const SRef& s)        { write(s.begin, s.length()); return *this; }
+
+    OutputBuffer& operator<<(bool val)               { put(val? '1' : '0'); return *this; }
+    OutputBuffer& operator<<(short val)              { putSigned(val); return *this; }
+    OutputBuffer& operator<<(unsigned short val)     { putUnsigned(val); return *this; }
+    OutputBuffer& operator<<(int val)                { putSigned(val); return *this; }
+    OutputBuffer& operator<<(unsigned val)           { putUnsigned(val); return *this; }
+    OutputBuffer& operator<<(long val)               { putSigned(val); return *this; }
+    OutputBuffer& operator<<(unsigned long val)      { putUnsigned(val); return *this; }
+    OutputBuffer& operator<<(long long val)          { putSigned(val); return *this; }
+    OutputBuffer& operator<<(unsigned long long val) { putUnsigned(val); return *this; }
+};
+
+}
+
+#endif
@@ -0,0 +1,496 @@
+// University of Illinois/NCSA
+// Open Source License
+//
+// Copyright (c) 2013-2015, Advanced Micro Devices, Inc.
+// All rights reserved.
+//
+// Developed by:
+//
+//     HSA Team
+//
+//     Advanced Micro Devices, Inc
+//
+//     www.amd.com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the "Software"), to deal with
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+//     * Redistributions of source code must retain the above copyright notice,
+//       this list of conditions and the following disclaimers.
+//
+//     * Redistributions in binary form must reproduce the above copyright notice,
+//       this list of conditions and the following disclaimers in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the names of the LLVM Team, University of Illinois at
+//       Urbana-Champaign, nor the names of its contributors may be used to
+//       endorse or promote products derived from this Software without specific
+//       prior written permission.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS WITH THE
+// SOFTWARE.
+#include "HSAILParser.h"
+#include "HSAILItems.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <exception>
+#include <map>
+#include <set>
+#include <string>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+namespace HSAIL_ASM
+{
+
+// Chunks smaller than that are not worth a separate parse.
+static const size_t minChunkSize = 64 * 1024;
+
+namespace {
+
+inline bool isIdChar(char c)
+{
+    return isalnum((unsigned char)c) || c=='_' || c=='$' || c=='%' || c=='&' || c=='@';
+}
+
+} // namespace
+
+bool TopLevelSplitter::split()
+{
+    const char* stmtBegin = NULL;
+    const char* body = NULL;
+    const char* init = NULL;
+    const char* loc = NULL;
+    bool locHasFile = false;
+    std::string bodyLoc;
+    int depth = 0;
+
+    for(const char* p = m_begin; p < m_end; ++p) {
+        char const c = *p;
+        if (isspace((unsigned char)c)) continue;
+        if (c=='/' && p + 1 < m_end && p[1]=='/') {
+            p = std::find(p, m_end, '\n');
+            continue;
+        }
+        if (c=='/' && p + 1 < m_end && p[1]=='*') {
+            const char* const e = std::search(p + 2, m_end, "*/", "*/" + 2);
+            if (e==m_end) return false;
+            p = e + 1;
+            continue;
+        }
+        if (c=='<' && p + 1 < m_end && p[1]=='#') return false; // embedded text
+        if (c=='\0') return false; // the scanner stops there
+
+        if (stmtBegin==NULL) {
+            if (depth!=0) return false;
+            stmtBegin = p;
+        }
+        switch(c) {
+        case '=':
+            if (depth==0 && init==NULL) init = p;
+            break;
+        case '"':
+            for(++p; p < m_end && *p!='"'; ++p) {
+                if (*p=='\\') ++p;
+            }
+            if (p >= m_end) return false;
+            locHasFile = loc!=NULL;
+            break;
+        case '{':
+            if (depth==0 && init==NULL && body==NULL) {
+                body = p;
+                bodyLoc.clear();
+            }
+            ++depth;
+            break;
+        case '}':
+            if (--depth < 0) return false;
+            break;
+        case ';':
+            if (loc!=NULL) {
+                if (locHasFile) bodyLoc.assign(loc, p + 1);
+                loc = NULL;
+            }
+            if (depth==0) {
+                stmtEnds.push_back(p + 1 - m_begin);
+                if (m_buildPrelude) {
+                    if (body!=NULL) {
+                        prelude += "decl ";
+                        prelude.append(stmtBegin, body);
+                        prelude += ";\n";
+                        if (!bodyLoc.empty()) {
+                            prelude += bodyLoc;
+                            prelude += "\n";
+                        }
+                    } else if (init!=NULL) {
+                        prelude.append(stmtBegin, init);
+                        prelude += ";\n";
+                    } else {
+                        prelude.append(stmtBegin, p + 1);
+                        prelude += "\n";
+                    }
+                    preludeSizes.push_back(prelude.size());
+                }
+                stmtBegin = body = init = NULL;
+            }
+            break;
+        case 'l':
+            if (depth > 0 && p + 3 <= m_end && p[1]=='o' && p[2]=='c' &&
+                !isIdChar(p[-1]) && (p + 3==m_end || !isIdChar(p[3]))) {
+                loc = p;
+                locHasFile = false;
+            }
+            break;
+        default:
+            break;
+        }
+    }
+    return stmtBegin==NULL && depth==0;
+}
+
+namespace {
+
+// Code/operand/data offsets of the items parsed from the own text of a chunk
+// are relocated to where the items go in the merged container. Items of the
+// prelude are not merged, references to them are resolved by name to the
+// module scope symbols merged before. Strings go through addString of the
+// merged container and lists are appended in the order of the chunk data
+// section, so the merged result is what a serial parse would have produced.
+class ChunkMerger
+{
+    BrigContainer& m_dst;
+    std::map<std::string, Offset> m_moduleScope; // first declaration wins as in Brigantine
+
+    BrigContainer* m_src;
+    const Offset*  m_ownStart;
+    Offset         m_base[BRIG_SECTION_INDEX_IMPLEMENTATION_DEFINED];
+    std::map<Offset, Offset> m_dataMap;
+    std::set<Offset> m_lists;
+    bool           m_failed;
+
+    bool isOwn(int section, Offset ofs) const { return ofs >= m_ownStart[section]; }
+
+    void relocItem(int section, Offset& ofs);
+    void relocData(Offset& ofs);
+
+    class ListCollector;
+    class Relocator;
+
+    template <typename Item>
+    void relocItems(int section);
+    template <typename Item>
+    void copyItems(int section);
+    void addModuleScopeSymbols();
+
+public:
+    ChunkMerger(BrigContainer& dst) : m_dst(dst) {}
+
+    bool merge(BrigContainer& src, const Offset* ownStart);
+};
+
+// relocates list elements, once per list, and records the own lists
+class ChunkMerger::ListCollector
+{
+    ChunkMerger& m_m;
+public:
+    ListCollector(ChunkMerger& m) : m_m(m) {}
+
+    template <typename I>
+    void operator()(ListRef<I> list, ...) {
+        Offset const ofs = list.deref();
+        if (ofs==0) return;
+        if (!m_m.isOwn(BRIG_SECTION_INDEX_DATA, ofs) || !m_m.m_lists.insert(ofs).second) {
+            m_m.m_failed = true;
+            return;
+        }
+        for(int i = 0, size = list.size(); i < size; ++i) {
+            m_m.relocItem(I::SECTION, list.writeAccess(i).deref());
+        }
+    }
+
+    template <typename T>
+    void operator()(const T&, ...) {} // all others
+};
+
+class ChunkMerger::Relocator
+{
+    ChunkMerger& m_m;
+public:
+    Relocator(ChunkMerger& m) : m_m(m) {}
+
+    template <typename I>
+    void operator()(ItemRef<I> ref, ...) { m_m.relocItem(I::SECTION, ref.deref()); }
+
+    template <typename I>
+    void operator()(ListRef<I> list, ...) { m_m.relocData(list.deref()); }
+
+    void operator()(StrRef str, ...) { m_m.relocData(str.deref()); }
+
+    template <typename T>
+    void operator()(const T&, ...) {} // all others
+};
+
+void ChunkMerger::relocItem(int section, Offset& ofs)
+{
+    if (ofs==0) return;
+    if (isOwn(section, ofs)) {
+        ofs = m_base[section] + (ofs - m_ownStart[section]);
+        return;
+    }
+    // only module scope symbols are referenced from the prelude
+    if (section==BRIG_SECTION_INDEX_CODE) {
+        Code const c(&m_src->code(), ofs);
+        SRef name;
+        if (DirectiveExecutable d = c) {
+            name = d.name();
+        } else if (DirectiveVariable d = c) {
+            name = d.name();
+        } else if (DirectiveFbarrier d = c) {
+            name = d.name();
+        } else if (DirectiveModule d = c) {
+            name = d.name();
+        }
+        std::map<std::string, Offset>::const_iterator const s =
+            m_moduleScope.find(std::string(name.begin, name.end));
+        if (s!=m_moduleScope.end()) {
+            ofs = s->second;
+            return;
+        }
+    }
+    m_failed = true;
+}
+
+void ChunkMerger::relocData(Offset& ofs)
+{
+    if (ofs==0) return;
+    if (isOwn(BRIG_SECTION_INDEX_DATA, ofs)) {
+        std::map<Offset, Offset>::const_iterator const d = m_dataMap.find(ofs);
+        if (d!=m_dataMap.end()) {
+            ofs = d->second;
+        } else {
+            m_failed = true;
+        }
+    } else {
+        // string of the prelude, must be there already
+        ofs = m_dst.strings().findString(m_src->strings().getString(ofs));
+        if (ofs==0) m_failed = true;
+    }
+}
+
+template <typename Item>
+void ChunkMerger::relocItems(int section)
+{
+    BrigSectionImpl& s = m_src->sectionById(section);
+    Relocator relocator(*this);
+    for(Item i(&s, m_ownStart[section]); i.brigOffset() < s.size(); i = i.next()) {
+        enumerateFields(i, relocator);
+    }
+}
+
+template <typename Item>
+void ChunkMerger::copyItems(int section)
+{
+    BrigSectionImpl& s = m_src->sectionById(section);
+    BrigSectionImpl& d = m_dst.sectionById(section);
+    assert(d.size()==m_base[section]);
+    d.insertData(d.size(), s.getData(m_ownStart[section]), s.getData(s.size()));
+    for(Item i(&s, m_ownStart[section]); i.brigOffset() < s.size(); i = i.next()) {
+        if (const SourceInfo* si = i.srcInfo()) {
+            d.annotate(Item(&d, m_base[section] + (i.brigOffset() - m_ownStart[section])), *si);
+        }
+    }
+}
+
+void ChunkMerger::addModuleScopeSymbols()
+{
+    for(Code c(&m_dst.code(), m_base[BRIG_SECTION_INDEX_CODE]); c != m_dst.code().end(); c = c.next()) {
+        SRef name;
+        if (DirectiveExecutable d = c) {
+            name = d.name();
+        } else if (DirectiveVariable d = c) {
+            name = d.name();
+        } else if (DirectiveFbarrier d = c) {
+            name = d.name();
+        } else if (DirectiveModule d = c) {
+            name = d.name();
+        }
+        if (!name.empty() && isGlobalName(name)) {
+            m_moduleScope.insert(std::make_pair(std::string(name.begin, name.end), c.brigOffset()));
+        }
+    }
+}
+
+bool ChunkMerger::merge(BrigContainer& src, const Offset* ownStart)
+{
+    m_src = &src;
+    m_ownStart = ownStart;
+    m_dataMap.clear();
+    m_lists.clear();
+    m_failed = false;
+    for(int i = 0; i < BRIG_SECTION_INDEX_IMPLEMENTATION_DEFINED; ++i) {
+        m_base[i] = m_dst.sectionById(i).size();
+    }
+
+    ListCollector collector(*this);
+    for(Code c(&src.code(), ownStart[BRIG_SECTION_INDEX_CODE]); c != src.code().end(); c = c.next()) {
+        enumerateFields(c, collector);
+    }
+    for(Operand o(&src.operands(), ownStart[BRIG_SECTION_INDEX_OPERAND]); o != src.operands().end(); o = o.next()) {
+        enumerateFields(o, collector);
+    }
+    if (m_failed) return false;
+
+    DataSection& data = src.strings();
+    size_t const hdrSize = offsetof(BrigData,bytes);
+    for(Offset ofs = ownStart[BRIG_SECTION_INDEX_DATA]; ofs < data.size();
+        ofs += (Offset)(hdrSize + align(data.getData<BrigData>(ofs)->byteCount, BrigSectionImpl::ITEM_ALIGNMENT))) {
+        SRef const s = data.getString(ofs);
+        m_dataMap[ofs] = m_lists.count(ofs) ? m_dst.strings().addStringImpl(s) : m_dst.strings().addString(s);
+    }
+
+    relocItems<Code>(BRIG_SECTION_INDEX_CODE);
+    relocItems<Operand>(BRIG_SECTION_INDEX_OPERAND);
+    if (m_failed) return false;
+
+    copyItems<Code>(BRIG_SECTION_INDEX_CODE);
+    copyItems<Operand>(BRIG_SECTION_INDEX_OPERAND);
+    addModuleScopeSymbols();
+    return true;
+}
+
+struct ParsedChunk
+{
+    std::string        text;
+    size_t             preludeSize;
+    BrigContainer      brig;
+    Offset             ownStart[BRIG_SECTION_INDEX_IMPLEMENTATION_DEFINED];
+    bool               ok;
+    std::exception_ptr error; // thrown by the parse other than SyntaxError
+
+    ParsedChunk() : preludeSize(0), ok(false) {}
+};
+
+} // namespace
+
+void Parser::parseSourceParallel(unsigned numThreads, bool saveSource)
+{
+    BrigContainer& container = m_bw.container();
+    SRef src = m_scanner.getPlainText();
+    while (!src.empty() && src.end[-1]=='\0') --src.end;
+
+    size_t const numChunks = std::min<size_t>(numThreads, src.length() / minChunkSize);
+    bool pristine = container.getNumSections()==BRIG_SECTION_INDEX_IMPLEMENTATION_DEFINED;
+    for(int i = 0; pristine && i < BRIG_SECTION_INDEX_IMPLEMENTATION_DEFINED; ++i) {
+        pristine = container.sectionById(i).isEmpty();
+    }
+    TopLevelSplitter splitter(src.begin, src.end);
+    if (numChunks < 2 || !pristine || !splitter.split()) {
+        return parseSource(saveSource);
+    }
+
+    // cut after the statements ending past equal portions of the text;
+    // the text of a chunk is preceded by the prelude padded so that the own
+    // text of the chunk starts at its original line and column
+    SourceLineIndex const lines(src.begin, src.end);
+    std::vector< std::unique_ptr<ParsedChunk> > chunks;
+    size_t chunkBegin = 0, preludeSize = 0;
+    for(size_t i = 1, stmt = 0; chunkBegin < src.length(); ++i) {
+        size_t chunkEnd = src.length(), nextPreludeSize = 0;
+        if (i < numChunks) {
+            size_t const target = src.length() / numChunks * i;
+            while (stmt < splitter.stmtEnds.size() && splitter.stmtEnds[stmt] < target) ++stmt;
+            if (stmt < splitter.stmtEnds.size()) {
+                chunkEnd = splitter.stmtEnds[stmt];
+                nextPreludeSize = splitter.preludeSizes[stmt];
+            }
+        }
+        if (chunkEnd == chunkBegin) continue;
+
+        std::unique_ptr<ParsedChunk> chunk(new ParsedChunk);
+        chunk->text.assign(splitter.prelude, 0, preludeSize);
+        SrcLoc const loc = lines.srcLoc(chunkBegin);
+        int const preludeLines = (int)std::count(chunk->text.begin(), chunk->text.end(), '\n');
+        if (preludeLines > loc.line) {
+            return parseSource(saveSource);
+        }
+        chunk->preludeSize = chunk->text.size();
+        chunk->text.append(loc.line - preludeLines, '\n');
+        chunk->text.append(loc.column, ' ');
+        chunk->text.append(src.begin + chunkBegin, src.begin + chunkEnd);
+        chunks.push_back(std::move(chunk));
+
+        chunkBegin = chunkEnd;
+        preludeSize = nextPreludeSize;
+    }
+    if (chunks.size() < 2) {
+        return parseSource(saveSource);
+    }
+
+    bool const disableComments = m_scanner.commentsDisabled();
+    std::atomic<size_t> next(0);
+    auto worker = [&]() {
+        for(size_t i; (i = next++) < chunks.size(); ) {
+            ParsedChunk& chunk = *chunks[i];
+            std::istringstream is(chunk.text);
+            Scanner scanner(is, disableComments);
+            Parser parser(scanner, chunk.brig);
+            try {
+                parser.parseChunk(chunk.preludeSize, chunk.ownStart);
+                chunk.ok = true;
+            } catch (const SyntaxError&) {
+                chunk.ok = false;
+            } catch (...) {
+                chunk.ok = false;
+                chunk.error = std::current_exception();
+            }
+        }
+    };
+    std::vector<std::thread> threads;
+    for(size_t i = 1; i < std::min<size_t>(numThreads, chunks.size()); ++i) {
+        threads.push_back(std::thread(worker));
+    }
+    worker();
+    for(size_t i = 0; i < threads.size(); ++i) {
+        threads[i].join();
+    }
+    for(size_t i = 0; i < chunks.size(); ++i) {
+        if (chunks[i]->error) std::rethrow_exception(chunks[i]->error);
+    }
+
+    bool ok = true;
+    for(size_t i = 0; ok && i < chunks.size(); ++i) {
+        ok = chunks[i]->ok;
+    }
+    if (ok) {
+        m_bw.startProgram();
+        ChunkMerger merger(container);
+        for(size_t i = 0; ok && i < chunks.size(); ++i) {
+            ok = merger.merge(chunks[i]->brig, chunks[i]->ownStart);
+            chunks[i].reset();
+        }
+        m_bw.endProgram();
+    }
+    if (!ok) {
+        // let the serial parse report the error
+        container.clear();
+        return parseSource(saveSource);
+    }
+
+    if (saveSource) {
+        saveSourceSection();
+    }
+}
+
+} // namespace HSAIL_ASM
@@ -567,13 +567,19 @@ void Parser::parseSource(bool saveSource)
     } while (peek().kind()!=EEndOfSource);
 
     if (saveSource) {
-        std::unique_ptr<BrigSectionImpl> sec(new BrigSectionRaw(SRef("source")));
-        SRef const t = m_scanner.getPlainText();
-        sec->insertData(sec->secHeader()->headerByteCount, t.begin, t.end);
-        m_bw.container().addSection(std::move(sec));
+        saveSourceSection();
     }
 }
 
+// Adds the text of the source as the "source" section.
+void Parser::saveSourceSection()
+{
+    std::unique_ptr<BrigSectionImpl> sec(new BrigSectionRaw(SRef("source")));
+    SRef const t = m_scanner.getPlainText();
+    sec->insertData(sec->secHeader()->headerByteCount, t.begin, t.end);
+    m_bw.container().addSection(std::move(sec));
+}
+
 void Parser::parseProgram()
 {
     PDBG;
@@ -587,6 +593,30 @@ void Parser::parseProgram()
     m_bw.endProgram();
 }
 
+// Parse one chunk of parseSourceParallel: first preludeSize chars of the
+// source re-declare what precedes the chunk in the module, ownStart receives
+// the section sizes at the end of the prelude. Module scope declarations are
+// not patched to definitions here, it's done once for the merged module.
+void Parser::parseChunk(size_t preludeSize, Offset* ownStart)
+{
+    PDBG;
+    m_bw.startProgram();
+
+    m_gcnEnabled = false;
+
+    const char* const ownBegin = m_scanner.getPlainText().begin + preludeSize;
+    while (peek().kind()!=EEndOfSource && peek().text().begin < ownBegin) {
+        parseTopLevelStatement();
+    }
+    BrigContainer& c = m_bw.container();
+    for(int i = 0; i < BRIG_SECTION_INDEX_IMPLEMENTATION_DEFINED; ++i) {
+        ownStart[i] = c.sectionById(i).size();
+    }
+    while (peek().kind()!=EEndOfSource) {
+        parseTopLevelStatement();
+    }
+}
+
 
 void Parser::parseModule()
 {
@@ -45,8 +45,11 @@
 #include "HSAILItems.h"
 #include "HSAILBrigantine.h"
 
+#include <cstddef>
 #include <stdexcept>
 #include <memory>
+#include <string>
+#include <vector>
 
 namespace HSAIL_ASM
 {
@@ -54,6 +57,7 @@ namespace HSAIL_ASM
 Inst parseMnemo(const char* str, Brigantine& bw);
 
 struct ModuleStatementPrefix;
+class IncrementalParser;
 
 class Parser
 {
@@ -62,6 +66,13 @@ public:
 
     void parseSource(bool saveSource=false);
 
+    /// same as parseSource but splits the source at top-level statements
+    /// into chunks which are parsed concurrently on up to numThreads threads
+    /// into private containers and then merged. The result is identical to
+    /// parseSource. Sources which are too small or cannot be split safely,
+    /// as well as sources with errors, are parsed serially.
+    void parseSourceParallel(unsigned numThreads, bool saveSource=false);
+
 private:
     enum ImmKind {
         TYPED_IMM = 1,
@@ -77,6 +88,8 @@ private:
 
     Parser& operator=(const Parser&);
 
+    friend class IncrementalParser;
+
     Scanner::CToken& scan()  { return m_scanner.scan(); }
     Scanner::CToken& peek()  { return m_scanner.peek(); }
     Scanner::CToken& token() { return m_scanner.token(); }
@@ -93,6 +106,8 @@ private:
     //SourceInfo tokenSourceInfo() const;
 
     void parseProgram();
+    void parseChunk(size_t preludeSize, Offset* ownStart);
+    void saveSourceSection();
     void parseModule();
     void parseTopLevelStatement();
     Optional<uint16_t> tryParseFBar();
@@ -168,6 +183,82 @@ private:
     void parseMLComment();
 };
 
+/// Text based pre-scan of a module: finds the ends of the top-level
+/// statements and optionally builds the prelude, the text that re-declares
+/// everything preceding a statement boundary. Executables with a body
+/// contribute their declaration, variables are copied without the
+/// initializer and other statements are copied as is. The last 'loc' naming
+/// a file inside a body is copied too because the file name carries over to
+/// the following 'loc' directives.
+class TopLevelSplitter
+{
+    const char* const m_begin;
+    const char* const m_end;
+    bool const        m_buildPrelude;
+
+public:
+    std::vector<size_t> stmtEnds;     // one past the ';' of each statement
+    std::vector<size_t> preludeSizes; // prelude size at each statement end
+    std::string         prelude;
+
+    TopLevelSplitter(const char* begin, const char* end, bool buildPrelude=true)
+        : m_begin(begin), m_end(end), m_buildPrelude(buildPrelude) {}
+
+    // false if the text is not split, the parser reports what's wrong
+    bool split();
+};
+
+/// Re-assembles a module after edits of its text. The first call parses the
+/// whole text, the following ones find the top-level statements that differ
+/// from the previous version by hash and re-parse only the statements from
+/// the first changed to the last changed one. Their code and operands
+/// replace the old ones in the container, references into the rest of the
+/// module are fixed up. Code and operands are laid out as after a full
+/// parse, only string offsets may differ as strings of the replaced
+/// statements are left in the data section. Edits of the module statement,
+/// of the set of module scope symbols or of the state carried to the
+/// following statements (extensions, file names of 'loc') are handled by a
+/// full parse.
+class IncrementalParser
+{
+public:
+    /// @param container - the container receives the module, its previous
+    /// contents are dropped on the first call.
+    IncrementalParser(BrigContainer& container, bool disableComments=true);
+
+    /// parse the new version of the text into the container. Throws
+    /// SyntaxError. If the error is in re-parsed statements, the container
+    /// keeps the previous version, otherwise the container is incomplete and
+    /// the next call parses the whole text.
+    void parse(const std::string& text);
+
+    /// number of top-level statements parsed by the last call
+    size_t numParsed() const { return m_numParsed; }
+
+private:
+    struct Segment
+    {
+        size_t      begin, end; // text of the statement and what precedes it
+        uint64_t    hash;
+        Offset      code;       // first code item
+        Offset      operand;    // first operand
+        bool        gcnEnabled; // parser state after the statement
+        std::string srcFileName;
+    };
+
+    BrigContainer&       m_container;
+    bool const           m_disableComments;
+    std::string          m_text;
+    std::vector<Segment> m_segments;
+    size_t               m_numParsed;
+
+    IncrementalParser& operator=(const IncrementalParser&);
+
+    void parseAll(const std::string& text, std::vector<Segment>& segs);
+    bool update(const std::string& text, std::vector<Segment>& segs);
+    void parseSegments(Parser& parser, ptrdiff_t shift, Segment* seg, Segment* end);
+};
+
 inline void Parser::syntaxError(const std::string& message,const SourceInfo* srcInfo) {
     if (srcInfo) {
         SrcLoc const srcLoc = { srcInfo->line, srcInfo->column };
@@ -41,11 +41,17 @@
 #include "HSAILScanner.h"
 
 #include <cassert>
+#include <cfloat>
+#include <cstring>
 #include <sstream>
 #include <algorithm>
 #include <limits>
 #include <utility>
 #include <strstream>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 
 StreamScannerBase::StreamScannerBase(std::istream& is)
     : m_end(0)
@@ -94,6 +100,64 @@ void chop(std::string& str)
     }
 }
 
+SourceLineIndex::SourceLineIndex(const char* begin, const char* end)
+{
+    reset(begin, end);
+    indexAll();
+}
+
+void SourceLineIndex::reset(const char* begin, const char* end)
+{
+    m_begin = begin;
+    m_end = end;
+    m_lineStarts.clear();
+    m_lineStarts.push_back(0);
+}
+
+void SourceLineIndex::indexAll()
+{
+    const char* p = m_begin + m_lineStarts.back();
+    while (p < m_end) {
+        const char* const nl = static_cast<const char*>(memchr(p, '\n', m_end - p));
+        if (nl == NULL) break;
+        p = nl + 1;
+        addLine(p - m_begin);
+    }
+}
+
+SrcLoc SourceLineIndex::srcLoc(size_t ofs) const
+{
+    std::vector<unsigned>::const_iterator const i =
+        std::upper_bound(m_lineStarts.begin(), m_lineStarts.end(), ofs) - 1;
+    SrcLoc const res = { static_cast<int>(i - m_lineStarts.begin()), static_cast<int>(ofs - *i) };
+    return res;
+}
+
+HSAIL_ASM::SRef SourceLineIndex::lineText(int line) const
+{
+    const char* begin;
+    if (line < 0) {
+        return HSAIL_ASM::SRef();
+    } else if (static_cast<size_t>(line) < m_lineStarts.size()) {
+        begin = m_begin + m_lineStarts[line];
+    } else {
+        // past the recorded lines, walk from the last one
+        begin = m_begin + m_lineStarts.back();
+        for(size_t n = m_lineStarts.size() - 1; n < static_cast<size_t>(line); ++n) {
+            const char* const nl = static_cast<const char*>(memchr(begin, '\n', m_end - begin));
+            if (nl == NULL) return HSAIL_ASM::SRef();
+            begin = nl + 1;
+        }
+    }
+    const char* end = static_cast<size_t>(line + 1) < m_lineStarts.size()
+        ? m_begin + m_lineStarts[line + 1] - 1
+        : static_cast<const char*>(memchr(begin, '\n', m_end - begin));
+    if (end == NULL) {
+        end = std::find(begin, m_end, '\0'); // scanner buffer is zero terminated
+    }
+    return HSAIL_ASM::SRef(begin, end);
+}
+
 // too long context string is truncated from the beginning, so 'second' in the resulting pair
 // is the srcLoc column in the truncated string
 std::pair<std::string,unsigned> getContextString(std::istream& is, const SrcLoc& srcLoc)
@@ -128,10 +192,31 @@ std::pair<std::string,unsigned> getContextString(std::istream& is, const SrcLoc&
     return res;
 }
 
-void printError(std::ostream& os, std::istream& is, const SrcLoc& errLoc, const char* message)
+std::pair<std::string,unsigned> getContextString(const SourceLineIndex& lines, const SrcLoc& srcLoc)
+{
+    using namespace std;
+    HSAIL_ASM::SRef const line = lines.lineText(srcLoc.line);
+
+    pair<string,unsigned> res;
+
+    size_t const lineLen = 80;
+    size_t start = 0;
+    if (srcLoc.column < static_cast<int>(lineLen)) {
+        res.second = srcLoc.column;
+    } else {
+        size_t const pfxLen = lineLen/2;
+        start = std::min(static_cast<size_t>(srcLoc.column) - pfxLen, line.length());
+        res.second = pfxLen;
+    }
+
+    res.first.assign(line.begin + start, std::min(line.length() - start, lineLen));
+    chop(res.first);
+    return res;
+}
+
+static void printError(std::ostream& os, const std::pair<std::string,unsigned>& ctxInfo, const SrcLoc& errLoc, const char* message)
 {
     using namespace std;
-    pair<string,unsigned> const ctxInfo = getContextString(is,errLoc);
     const std::string& ctxStr = ctxInfo.first;
     unsigned const ctxStrPos = ctxInfo.second;
 
@@ -147,6 +232,16 @@ void printError(std::ostream& os, std::istream& is, const SrcLoc& errLoc, const
     os << "input" << '(' << errLoc.line+1 << ',' <<  errLoc.column+1 << "): " << message << endl;
 }
 
+void printError(std::ostream& os, std::istream& is, const SrcLoc& errLoc, const char* message)
+{
+    printError(os, getContextString(is,errLoc), errLoc, message);
+}
+
+void printError(std::ostream& os, const SourceLineIndex& lines, const SrcLoc& errLoc, const char* message)
+{
+    printError(os, getContextString(lines,errLoc), errLoc, message);
+}
+
 
 
 namespace HSAIL_ASM
@@ -160,6 +255,191 @@ public:
     }
 };
 
+//-----------------------------------------------------------------------------
+// Numeric literals
+
+static inline unsigned hexDigitValue(char c)
+{
+    if (c <= '9') return c - '0';
+    return (c | 0x20) - 'a' + 10;
+}
+
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+#define HSAIL_SWAR_DIGITS 0
+#else
+#define HSAIL_SWAR_DIGITS 1
+#endif
+
+// value of 8 decimal digits at p, converted in a 64-bit register:
+// adjacent digits are combined into pairs, pairs into quads, quads into the result
+static inline uint32_t parseEightDigits(const char* p)
+{
+#if HSAIL_SWAR_DIGITS
+    uint64_t v;
+    memcpy(&v, p, sizeof v);
+    v -= 0x3030303030303030ULL;
+    v = (v * 10) + (v >> 8);
+    v = (((v & 0x000000FF000000FFULL) * (100 + (1000000ULL << 32))) +
+         (((v >> 16) & 0x000000FF000000FFULL) * (1 + (10000ULL << 32)))) >> 32;
+    return (uint32_t)v;
+#else
+    uint32_t v = 0;
+    for(int i = 0; i < 8; ++i) v = v * 10 + (p[i] - '0');
+    return v;
+#endif
+}
+
+bool parseDecDigits(const SRef& s, uint64_t& res)
+{
+    const char* p = s.begin;
+    while (p != s.end && *p == '0') ++p;
+
+    // 19 digits never overflow, the 20th one needs a check
+    size_t const numDigits = s.end - p;
+    if (numDigits > 20) return false;
+    const char* const safeEnd = p + (std::min)(numDigits, (size_t)19);
+
+    uint64_t v = 0;
+    for(; safeEnd - p >= 8; p += 8) {
+        v = v * 100000000 + parseEightDigits(p);
+    }
+    for(; p != safeEnd; ++p) {
+        v = v * 10 + (*p - '0');
+    }
+    if (p != s.end) {
+        unsigned const d = *p - '0';
+        if (v > ((std::numeric_limits<uint64_t>::max)() - d) / 10) return false;
+        v = v * 10 + d;
+    }
+    res = v;
+    return true;
+}
+
+bool parseOctDigits(const SRef& s, uint64_t& res)
+{
+    const char* p = s.begin;
+    while (p != s.end && *p == '0') ++p;
+
+    size_t const numDigits = s.end - p;
+    if (numDigits > 22 || (numDigits == 22 && *p > '1')) return false;
+
+    uint64_t v = 0;
+    for(; p != s.end; ++p) {
+        v = (v << 3) | (*p - '0');
+    }
+    res = v;
+    return true;
+}
+
+bool parseHexDigits(const SRef& s, uint64_t& res)
+{
+    const char* p = s.begin;
+    while (p != s.end && *p == '0') ++p;
+
+    if (s.end - p > 16) return false;
+
+    uint64_t v = 0;
+    for(; p != s.end; ++p) {
+        v = (v << 4) | hexDigitValue(*p);
+    }
+    res = v;
+    return true;
+}
+
+template <typename T> struct DecFloatFastPath;
+
+template <> struct DecFloatFastPath<float> {
+    static const uint64_t maxMantissa = 1ULL << 24;
+    static const int maxExp10 = 10;
+    static float pow10(int e) {
+        static const float p[] = { 1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f };
+        return p[e];
+    }
+};
+
+template <> struct DecFloatFastPath<double> {
+    static const uint64_t maxMantissa = 1ULL << 53;
+    static const int maxExp10 = 22;
+    static double pow10(int e) {
+        static const double p[] = {
+            1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+            1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+        return p[e];
+    }
+};
+
+template <typename T>
+static bool parseDecFloatFastImpl(const SRef& s, T& res)
+{
+#if defined(FLT_EVAL_METHOD) && (FLT_EVAL_METHOD != 0)
+    // excess precision of intermediate results breaks exactness
+    return false;
+#endif
+    typedef DecFloatFastPath<T> Limits;
+    const char* p = s.begin;
+    const char* const end = s.end;
+
+    bool const negative = (p != end && *p == '-');
+    if (p != end && (*p == '-' || *p == '+')) ++p;
+
+    uint64_t mantissa = 0;
+    int numDigits = 0; // significant ones
+    int exp10 = 0;
+    for(; p != end && unsigned(*p - '0') < 10; ++p) {
+        if (mantissa == 0 && *p == '0') continue;
+        if (++numDigits > 19) return false;
+        mantissa = mantissa * 10 + (*p - '0');
+    }
+    if (p != end && *p == '.') {
+        for(++p; p != end && unsigned(*p - '0') < 10; ++p) {
+            --exp10;
+            if (mantissa == 0 && *p == '0') continue;
+            if (++numDigits > 19) return false;
+            mantissa = mantissa * 10 + (*p - '0');
+        }
+    }
+    if (p != end && (*p == 'e' || *p == 'E')) {
+        ++p;
+        bool const negExp = (p != end && *p == '-');
+        if (p != end && (*p == '-' || *p == '+')) ++p;
+        int e = 0;
+        for(; p != end && unsigned(*p - '0') < 10; ++p) {
+            if (e < 100000) e = e * 10 + (*p - '0'); // saturate, such values are out of range anyway
+        }
+        exp10 += negExp ? -e : e;
+    }
+    if (p != end) return false;
+
+    if (mantissa == 0) {
+        res = negative ? -T(0) : T(0);
+        return true;
+    }
+    if (mantissa > Limits::maxMantissa || exp10 < -Limits::maxExp10 || exp10 > Limits::maxExp10) {
+        return false;
+    }
+    // both operands are exact, so the result is correctly rounded
+    T v = static_cast<T>(mantissa);
+    v = (exp10 < 0) ? v / Limits::pow10(-exp10) : v * Limits::pow10(exp10);
+    res = negative ? -v : v;
+    return true;
+}
+
+bool parseDecFloatFast(const SRef& s, float& res)  { return parseDecFloatFastImpl(s, res); }
+bool parseDecFloatFast(const SRef& s, double& res) { return parseDecFloatFastImpl(s, res); }
+
+// the rest goes through the standard library which rounds correctly
+template <typename T>
+static T readDecFloat(const SRef& s)
+{
+    T v;
+    if (!parseDecFloatFast(s, v)) {
+        std::istrstream is(s.begin, s.length());
+        is.exceptions(std::ios::failbit | std::ios::badbit);
+        is >> v;
+    }
+    return v;
+}
+
 Scanner::Scanner(std::istream& is,bool disableComments)
     : StreamScannerBase(is)
     , m_peekToken(NULL)
@@ -167,6 +447,9 @@ Scanner::Scanner(std::istream& is,bool disableComments)
     , m_lineStart(0)
     , m_disableComments(disableComments)
 {
+    if (!m_buffer.empty()) {
+        m_lines.reset(&m_buffer[0], m_end);
+    }
 
     m_pool[0].m_scanner = this;
     m_pool[1].m_scanner = this;
@@ -232,10 +515,278 @@ void Scanner::readSingleStringLiteral(std::string& outString) {
     m_curToken = &t;
 }
 
+// ============================================================================
+// Pipelined scanning. A second scanner over a copy of the text runs on its
+// own thread and pushes compact tokens into a ring. Tokens are matched to
+// requests by the offset scanning started at and by context, anything not
+// matched is scanned by the requesting thread. A restart bumps the
+// generation, tokens of older generations are dropped by the consumer.
+
+class Scanner::Pipeline
+{
+public:
+    explicit Pipeline(Scanner& owner);
+    ~Pipeline();
+
+    bool take(EScanContext ctx, Token& t);
+
+private:
+    struct Entry {
+        unsigned generation;
+        unsigned scanStart;    // offset where scanning of the token started
+        unsigned begin;
+        unsigned end;
+        unsigned lineStart;    // line of the token
+        int      lineNum;
+        unsigned endLineStart; // line the scanner is on after the token
+        int      endLineNum;
+        int      brigId;
+        short    kind;         // EEmpty marks a position the thread failed to scan
+        short    ctx;
+    };
+
+    struct StartPoint {
+        unsigned     pos;
+        unsigned     lineStart;
+        int          lineNum;
+        EScanContext ctx;
+        bool         inString;
+    };
+
+    enum { RING_SIZE = 1024 };
+
+    Scanner&                 m_owner;
+    std::istrstream          m_text;
+    Scanner                  m_lexer;
+
+    std::vector<Entry>       m_ring;
+    std::atomic<unsigned>    m_head;     // written by the thread
+    std::atomic<unsigned>    m_tail;     // written by the consumer
+    std::atomic<unsigned>    m_generation;
+    std::atomic<unsigned>    m_finished; // last generation the thread has run to the end
+    std::atomic<bool>        m_quit;
+
+    std::mutex               m_mutex;
+    std::condition_variable  m_cv;
+    StartPoint               m_start;
+    bool                     m_startPending;
+
+    std::thread              m_thread;
+
+    void restart(EScanContext ctx);
+    void run();
+    void produce(unsigned generation, const StartPoint& start);
+    bool push(unsigned generation, unsigned scanStart, const Token& t, EScanContext ctx);
+    unsigned offsetOf(const Scanner& s, const char* p) const {
+        return static_cast<unsigned>(s.streamPosAt(p));
+    }
+};
+
+Scanner::Pipeline::Pipeline(Scanner& owner)
+    : m_owner(owner)
+    , m_text(owner.m_buffer.empty() ? "" : &owner.m_buffer[0],
+             owner.m_buffer.empty() ? 0 : owner.m_end - &owner.m_buffer[0])
+    , m_lexer(m_text)
+    , m_ring(RING_SIZE)
+    , m_head(0)
+    , m_tail(0)
+    , m_generation(0)
+    , m_finished(0)
+    , m_quit(false)
+    , m_startPending(false)
+{
+    m_thread = std::thread(&Pipeline::run, this);
+    restart(EDefaultContext);
+}
+
+Scanner::Pipeline::~Pipeline()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_quit = true;
+        ++m_generation;
+    }
+    m_cv.notify_one();
+    m_thread.join();
+}
+
+void Scanner::Pipeline::restart(EScanContext ctx)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_start.pos       = offsetOf(m_owner, m_owner.m_curToken->m_text.end);
+        m_start.lineStart = static_cast<unsigned>(m_owner.m_lineStart);
+        m_start.lineNum   = m_owner.m_lineNum;
+        m_start.ctx       = ctx >= EInstModifierContext ? EInstModifierContext : EDefaultContext;
+        m_start.inString  = m_owner.m_curToken->kind() == EStringLiteral;
+        m_startPending    = true;
+        ++m_generation;
+    }
+    m_cv.notify_one();
+}
+
+void Scanner::Pipeline::run()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+        while (!m_quit && !m_startPending) m_cv.wait(lock);
+        if (m_quit) return;
+        m_startPending = false;
+        StartPoint const start = m_start;
+        unsigned const generation = m_generation;
+        lock.unlock();
+        produce(generation, start);
+        m_finished.store(generation, std::memory_order_release);
+        lock.lock();
+    }
+}
+
+bool Scanner::Pipeline::push(unsigned generation, unsigned scanStart, const Token& t, EScanContext ctx)
+{
+    unsigned const head = m_head.load(std::memory_order_relaxed);
+    while (head - m_tail.load(std::memory_order_acquire) == RING_SIZE) {
+        if (m_generation.load(std::memory_order_relaxed) != generation) return false;
+        std::this_thread::yield();
+    }
+    if (m_generation.load(std::memory_order_relaxed) != generation) return false;
+
+    Entry& e = m_ring[head % RING_SIZE];
+    e.generation   = generation;
+    e.scanStart    = scanStart;
+    e.begin        = offsetOf(m_lexer, t.m_text.begin);
+    e.end          = offsetOf(m_lexer, t.m_text.end);
+    e.lineStart    = static_cast<unsigned>(t.m_lineStart);
+    e.lineNum      = t.m_lineNum;
+    e.endLineStart = static_cast<unsigned>(m_lexer.m_lineStart);
+    e.endLineNum   = m_lexer.m_lineNum;
+    e.brigId       = t.m_brigId;
+    e.kind         = static_cast<short>(t.m_kind);
+    e.ctx          = static_cast<short>(ctx);
+    m_head.store(head + 1, std::memory_order_release);
+    return true;
+}
+
+void Scanner::Pipeline::produce(unsigned generation, const StartPoint& start)
+{
+    Scanner& s = m_lexer;
+    Token& cur = s.m_pool[0];
+    cur.m_kind = start.inString ? EStringLiteral : EEmpty;
+    cur.m_text.begin = cur.m_text.end = s.m_buffer.empty() ? NULL : &s.m_buffer[0] + start.pos;
+    s.m_curToken  = &cur;
+    s.m_peekToken = NULL;
+    s.m_lineNum   = start.lineNum;
+    s.m_lineStart = start.lineStart;
+
+    EScanContext ctx = start.ctx;
+    bool inString = start.inString;
+    std::string str;
+    unsigned scanStart = start.pos;
+    try {
+        while (true) {
+            scanStart = offsetOf(s, s.m_curToken->m_text.end);
+            CToken& t = s.scan(ctx);
+            if (!push(generation, scanStart, t, ctx)) return;
+
+            if (ctx != EDefaultContext) {
+                if (t.kind() == EMNone) ctx = EDefaultContext;
+                continue;
+            }
+            switch(t.kind()) {
+            case EEndOfSource:
+                return;
+            case EQuot:
+                if (!inString) s.readSingleStringLiteral(str);
+                inString = !inString;
+                break;
+            case EMLCommentStart:
+                while (s.continueMLComment()) {}
+                break;
+            default:
+                if (*t.text().end == '_') ctx = EInstModifierContext;
+            }
+        }
+    } catch (const SyntaxError&) {
+        // leave a marker, the consumer scans this position itself and restarts us past it
+        Token& t = s.newToken();
+        t.m_text.begin = t.m_text.end = &s.m_buffer[0] + scanStart;
+        t.m_lineStart = s.m_lineStart;
+        t.m_lineNum = s.m_lineNum;
+        t.m_brigId = 0;
+        t.m_kind = EEmpty;
+        push(generation, scanStart, t, ctx);
+    }
+}
+
+bool Scanner::Pipeline::take(EScanContext ctx, Token& t)
+{
+    unsigned const pos = offsetOf(m_owner, m_owner.m_curToken->m_text.end);
+    unsigned const generation = m_generation.load(std::memory_order_relaxed);
+    unsigned tail = m_tail.load(std::memory_order_relaxed);
+    unsigned head;
+    while (true) {
+        head = m_head.load(std::memory_order_acquire);
+        while (tail != head) {
+            const Entry& e = m_ring[tail % RING_SIZE];
+            if (e.generation == generation && e.scanStart >= pos) break;
+            ++tail;
+        }
+        m_tail.store(tail, std::memory_order_release);
+        if (tail != head) break;
+        if (m_finished.load(std::memory_order_acquire) == generation) {
+            restart(ctx);
+            return false;
+        }
+        std::this_thread::yield();
+    }
+
+    if (m_ring[tail % RING_SIZE].scanStart > pos) { // thread lost track of the consumer
+        restart(ctx);
+        return false;
+    }
+    for(unsigned i = tail; i != head && m_ring[i % RING_SIZE].scanStart == pos; ++i) {
+        const Entry& e = m_ring[i % RING_SIZE];
+        if (e.ctx != ctx || e.kind == EEmpty) continue;
+        const char* const base = &m_owner.m_buffer[0];
+        t.m_text.begin = base + e.begin;
+        t.m_text.end   = base + e.end;
+        t.m_lineStart  = e.lineStart;
+        t.m_lineNum    = e.lineNum;
+        t.m_brigId     = e.brigId;
+        t.m_kind       = static_cast<ETokens>(e.kind);
+        m_owner.m_lineStart = e.endLineStart;
+        m_owner.m_lineNum   = e.endLineNum;
+        return true;
+    }
+    return false;
+}
+
+Scanner::~Scanner()
+{
+}
+
+void Scanner::enablePipelining()
+{
+    if (!m_pipeline && !m_buffer.empty()) {
+        m_pipeline.reset(new Pipeline(*this));
+    }
+}
+
+const SourceLineIndex& Scanner::lineIndex()
+{
+    if (m_pipeline) {
+        m_pipeline.reset();
+        m_lines.indexAll();
+    }
+    return m_lines;
+}
+
 Scanner::Token& Scanner::scanNext(EScanContext ctx)
 {
     const char* const curPos = m_curToken->m_text.end;
     Token& t = newToken();
+    if (m_pipeline && m_pipeline->take(ctx, t)) {
+        return t;
+    }
     t.m_lineStart = m_lineStart;
     t.m_lineNum = m_lineNum;
     t.m_text.begin = t.m_text.end = curPos;
@@ -254,6 +805,9 @@ Scanner::Token& Scanner::scanNext(EScanContext ctx)
 void Scanner::nextLine(const char *atPos)
 {
     m_lineStart = streamPosAt(atPos);
+    if (!m_pipeline) { // completed when pipelining stops
+        m_lines.addLine(static_cast<size_t>(m_lineStart));
+    }
     ++m_lineNum;
 }
 
@@ -266,18 +820,18 @@ SrcLoc Scanner::srcLoc(const char* pos) const {
 
 uint64_t Scanner::readIntLiteral()
 {
-    using namespace std;
-    uint64_t v;
+    uint64_t v = 0;
+    bool ok = false;
     switch(eatToken(EIntLiteral)) {
-    case ELitDecimal:
-        istringstreamalert(m_curToken->text()) >> dec >> v;        break;
-    case ELitOctal:
-        istringstreamalert(m_curToken->text().substr(1)) >> oct >> v; break;
-    case ELitHex:
-        istringstreamalert(m_curToken->text().substr(2)) >> hex >> v; break;
+    case ELitDecimal: ok = parseDecDigits(m_curToken->text(), v);           break;
+    case ELitOctal:   ok = parseOctDigits(m_curToken->text().substr(1), v); break;
+    case ELitHex:     ok = parseHexDigits(m_curToken->text().substr(2), v); break;
     default:
         assert(0);
     }
+    if (!ok) {
+        syntaxError("Integer literal is too large");
+    }
     return v;
 }
 
@@ -287,21 +841,19 @@ f16_t Scanner::readF16Literal()
     switch(eatToken(EF16Literal)) {
     case ELitDecimal:
         {
-            float v;
-            istringstreamalert(m_curToken->text()) >> v;
+            float v = readDecFloat<float>(m_curToken->text());
             return f16_t(f32_t(&v));
         }
     case ELitDecimalWithSuffix:
         {
-            float v;
-            istringstreamalert(m_curToken->text().rsubstr(1)) >> v;
+            float v = readDecFloat<float>(m_curToken->text().rsubstr(1));
             return f16_t(f32_t(&v));
         }
     case ELitHex:
         {
-            IEEE754Traits<f16_t>::RawBitsType v;
-            istringstreamalert(m_curToken->text().substr(2)) >> hex >> v;
-            return f16_t::fromRawBits(v);
+            uint64_t v = 0;
+            parseHexDigits(m_curToken->text().substr(2), v); // fixed number of digits
+            return f16_t::fromRawBits(static_cast<IEEE754Traits<f16_t>::RawBitsType>(v));
         }
     case ELitC99:
         {
@@ -319,21 +871,19 @@ f32_t Scanner::readF32Literal()
     switch(eatToken(EF32Literal)) {
     case ELitDecimal:
         {
-            float v;
-            istringstreamalert(m_curToken->text()) >> v;
+            float v = readDecFloat<float>(m_curToken->text());
             return f32_t(&v);
         }
     case ELitDecimalWithSuffix:
         {
-            float v;
-            istringstreamalert(m_curToken->text().rsubstr(1)) >> v;
+            float v = readDecFloat<float>(m_curToken->text().rsubstr(1));
             return f32_t(&v);
         }
     case ELitHex:
         {
-            IEEE754Traits<f32_t>::RawBitsType v;
-            istringstreamalert(m_curToken->text().substr(2)) >> hex >> v;
-            return f32_t::fromRawBits(v);
+            uint64_t v = 0;
+            parseHexDigits(m_curToken->text().substr(2), v); // fixed number of digits
+            return f32_t::fromRawBits(static_cast<IEEE754Traits<f32_t>::RawBitsType>(v));
         }
     case ELitC99:
         {
@@ -351,21 +901,19 @@ f64_t Scanner::readF64Literal()
     switch(eatToken(EF64Literal)) {
     case ELitDecimal:
         {
-            double v;
-            istringstreamalert(m_curToken->text()) >> v;
+            double v = readDecFloat<double>(m_curToken->text());
             return f64_t(&v);
         }
     case ELitDecimalWithSuffix:
         {
-            double v;
-            istringstreamalert(m_curToken->text().rsubstr(1)) >> v;
+            double v = readDecFloat<double>(m_curToken->text().rsubstr(1));
             return f64_t(&v);
         }
     case ELitHex:
         {
-            IEEE754Traits<f64_t>::RawBitsType v;
-            istringstreamalert(m_curToken->text().substr(2)) >> hex >> v;
-            return f64_t::fromRawBits(v);
+            uint64_t v = 0;
+            parseHexDigits(m_curToken->text().substr(2), v); // fixed number of digits
+            return f64_t::fromRawBits(static_cast<IEEE754Traits<f64_t>::RawBitsType>(v));
         }
     case ELitC99:
         {
@@ -79,7 +79,44 @@ struct SrcLoc
     int column;
 };
 
+// Start offsets of the lines of a source text kept in memory. Lets
+// diagnostics find a line or the line/column of an offset with a binary
+// search instead of re-reading the input stream for every message.
+class SourceLineIndex
+{
+    const char*           m_begin;
+    const char*           m_end;
+    std::vector<unsigned> m_lineStarts;
+
+public:
+    SourceLineIndex() { reset(NULL, NULL); }
+    SourceLineIndex(const char* begin, const char* end); // indexes the whole text
+
+    // forget all lines and refer to the new text, which must outlive the index
+    void reset(const char* begin, const char* end);
+
+    // record that a line starts at ofs, offsets must come in increasing order;
+    // an already recorded offset is ignored
+    void addLine(size_t ofs) {
+        if (ofs > m_lineStarts.back()) {
+            m_lineStarts.push_back(static_cast<unsigned>(ofs));
+        }
+    }
+
+    // record the rest of the lines up to the end of the text
+    void indexAll();
+
+    unsigned numLines() const { return static_cast<unsigned>(m_lineStarts.size()); }
+
+    // location of the char at ofs, lines not recorded yet are not accounted for
+    SrcLoc srcLoc(size_t ofs) const;
+
+    // text of the line without line terminator, empty if line is past the end
+    HSAIL_ASM::SRef lineText(int line) const;
+};
+
 void printError(std::ostream& os, std::istream& is, const SrcLoc& errLoc, const char* message);
+void printError(std::ostream& os, const SourceLineIndex& lines, const SrcLoc& errLoc, const char* message);
 
 class SyntaxError
 {
@@ -106,6 +143,9 @@ public:
     void print(std::ostream& os, std::istream& is) const {
         printError(os,is,m_srcLoc,m_errorMessage.c_str());
     }
+    void print(std::ostream& os, const SourceLineIndex& lines) const {
+        printError(os,lines,m_srcLoc,m_errorMessage.c_str());
+    }
 };
 
 class StreamScannerBase
@@ -299,10 +339,36 @@ enum EScanContext {
     EInstModifierInstQueryContext,
 };
 
+// Conversion of numeric literal text matched by the scanner rules, working
+// directly on the token text without streams or allocations. Digits only,
+// prefixes such as "0x" must be stripped. Return false if the value does
+// not fit into 64 bits.
+bool parseDecDigits(const SRef& s, uint64_t& res);
+bool parseOctDigits(const SRef& s, uint64_t& res);
+bool parseHexDigits(const SRef& s, uint64_t& res);
+
+// Decimal floating point literal with optional sign and no suffix. Only
+// handles values which are converted exactly with a single multiplication
+// or division by a power of 10 (Clinger's fast path), which covers most of
+// the literals; returns false for the rest.
+bool parseDecFloatFast(const SRef& s, float& res);
+bool parseDecFloatFast(const SRef& s, double& res);
+
 class Scanner : public StreamScannerBase
 {
 public:
     explicit Scanner(std::istream& is, bool disableComments=true);
+    ~Scanner();
+
+    // Tokenize ahead on a separate thread while the caller parses. The
+    // thread predicts contexts: it scans in the default context and switches
+    // to the instruction modifier context right after a token followed by
+    // '_'. Tokens requested in another context, or at a position the thread
+    // did not predict, are scanned by the caller as without pipelining and
+    // the thread restarts from there. The results are the same either way.
+    void enablePipelining();
+
+    bool commentsDisabled() const { return m_disableComments; }
 
     class Token {
         friend class Scanner;
@@ -324,6 +390,10 @@ public:
 
     CToken& token() const { return *m_curToken; }
 
+    // lines seen so far by the scanner, all lines if pipelining was enabled;
+    // stops pipelining
+    const SourceLineIndex& lineIndex();
+
     SrcLoc srcLoc(const CToken& t) const {
       std::streamoff const posOfs = streamPosAt(t.m_text.begin);
       assert(posOfs >= t.m_lineStart);
@@ -389,10 +459,14 @@ private:
 
     int                        m_lineNum;
     std::streamoff             m_lineStart;
+    SourceLineIndex            m_lines;
     bool                       m_disableComments;
 
     class istringstreamalert;
     class Variant;
+    class Pipeline;
+
+    std::unique_ptr<Pipeline>  m_pipeline;
 
     Token&       newToken();
     Token&       scanNext(EScanContext ctx);
@@ -39,6 +39,7 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS WITH THE
 // SOFTWARE.
 #include "HSAILScanner.h"
+#include "HSAILCharScan.h"
 #include "Brig.h"
 #include <sstream>
 #include <limits>
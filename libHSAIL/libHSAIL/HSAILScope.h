@@ -42,11 +42,130 @@
 #ifndef INCLUDED_HSAIL_SCOPE_H
 #define INCLUDED_HSAIL_SCOPE_H
 
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
 namespace HSAIL_ASM {
 
+/// maps names to 32-bit values. Open addressing hash table keyed by the
+/// names, which are copied to the map's own storage; hashes are kept along
+/// with the entries. clear() takes constant time and keeps the memory for
+/// reuse.
+class NameMap {
+    struct Entry {
+        uint32_t hash;
+        uint32_t keyLength;
+        uint32_t keyOffset;  // in d_keys
+        uint32_t value;
+        uint32_t generation; // the slot is empty unless it's d_generation
+    };
+    enum { MIN_TABLE_SIZE = 16 };
+
+    std::vector<Entry> d_table; // size is a power of 2
+    std::vector<char>  d_keys;
+    unsigned           d_size;
+    uint32_t           d_generation;
+
+    static uint32_t hash(const SRef& name);
+    Entry* find(const SRef& name, uint32_t h);
+    void   grow();
+
+public:
+    NameMap() : d_size(0), d_generation(1) {}
+
+    /// value of the name, NULL if there is none.
+    uint32_t* find(const SRef& name) {
+        if (d_size==0) return NULL;
+        Entry* const e = find(name, hash(name));
+        return e->generation==d_generation ? &e->value : NULL;
+    }
+
+    /// add the name unless it's there already.
+    /// @return - the value of the name, valid till the next insertion.
+    uint32_t* insert(const SRef& name, uint32_t value, bool& added);
+
+    void clear();
+};
+
+inline uint32_t NameMap::hash(const SRef& name) {
+    uint32_t h = 2166136261u; // FNV-1a
+    for(const char* p = name.begin; p != name.end; ++p) {
+        h = (h ^ (unsigned char)*p) * 16777619u;
+    }
+    return h;
+}
+
+// the entry of the name or the empty slot where it goes
+inline NameMap::Entry* NameMap::find(const SRef& name, uint32_t h) {
+    size_t const mask = d_table.size() - 1;
+    size_t const length = name.length();
+    for(size_t i = h & mask; ; i = (i + 1) & mask) {
+        Entry& e = d_table[i];
+        if (e.generation!=d_generation) {
+            return &e;
+        }
+        if (e.hash==h && e.keyLength==length &&
+            (length==0 || memcmp(d_keys.data() + e.keyOffset, name.begin, length)==0)) {
+            return &e;
+        }
+    }
+}
+
+inline uint32_t* NameMap::insert(const SRef& name, uint32_t value, bool& added) {
+    if ((d_size + 1) * 4 > d_table.size() * 3) {
+        grow();
+    }
+    uint32_t const h = hash(name);
+    Entry* const e = find(name, h);
+    added = e->generation!=d_generation;
+    if (added) {
+        e->hash = h;
+        e->keyLength = (uint32_t)name.length();
+        e->keyOffset = (uint32_t)d_keys.size();
+        e->value = value;
+        e->generation = d_generation;
+        d_keys.insert(d_keys.end(), name.begin, name.end);
+        ++d_size;
+    }
+    return &e->value;
+}
+
+inline void NameMap::grow() {
+    Entry const empty = { 0, 0, 0, 0, 0 };
+    std::vector<Entry> table(std::max<size_t>(d_table.size() * 2, MIN_TABLE_SIZE), empty);
+    size_t const mask = table.size() - 1;
+    for(size_t i = 0; i < d_table.size(); ++i) {
+        if (d_table[i].generation==d_generation) {
+            size_t j = d_table[i].hash & mask;
+            while (table[j].generation!=0) j = (j + 1) & mask;
+            table[j] = d_table[i];
+        }
+    }
+    d_table.swap(table);
+    for(size_t i = 0; i < d_table.size(); ++i) {
+        if (d_table[i].generation!=0) d_table[i].generation = 1;
+    }
+    d_generation = 1;
+}
+
+inline void NameMap::clear() {
+    if (d_size > 0) {
+        d_keys.clear();
+        d_size = 0;
+        if (++d_generation==0) {
+            for(size_t i = 0; i < d_table.size(); ++i) {
+                d_table[i].generation = 0;
+            }
+            d_generation = 1;
+        }
+    }
+}
+
+/// names visible in a scope. clear() keeps the memory so a scope can be
+/// reused for the next function or argument block.
 class Scope {
-    typedef std::map<std::string, Offset> Map;
-    Map            d_map;
+    NameMap        d_names;
     BrigContainer* d_container_p;
 
 public:
@@ -58,6 +177,9 @@ public:
 
     BrigContainer* container() const { return d_container_p; }
 
+    /// forget all names.
+    void clear() { d_names.clear(); }
+
     template<typename Item>
     Item get(const SRef& name);
 
@@ -70,9 +192,8 @@ public:
 
 template<typename Item>
 Item Scope::get(const SRef& name) {
-    Map::iterator p = d_map.find(std::string(name.begin, name.end));
-    if (p != d_map.end()) {
-        return typename Item::Kind(d_container_p, p->second);
+    if (const Offset* p = d_names.find(name)) {
+        return typename Item::Kind(d_container_p, *p);
     }
     else {
         return Item();
@@ -81,19 +202,16 @@ Item Scope::get(const SRef& name) {
 
 template<typename Item>
 bool Scope::add(const SRef& name, const Item& item) {
-    std::pair<Map::iterator, bool> res =
-        d_map.insert(std::make_pair(std::string(name.begin,name.end), item.brigOffset()));
-    return res.second;
+    bool added;
+    d_names.insert(name, item.brigOffset(), added);
+    return added;
 }
 
 template<typename Item>
 bool Scope::replaceOtherwiseAdd(const SRef& name, const Item& item) {
-    std::pair<Map::iterator, bool> res =
-        d_map.insert(std::make_pair(std::string(name.begin,name.end), item.brigOffset()));
-    if (res.second==false) {
-        (*res.first).second = item.brigOffset();
-    }
-    return res.second;
+    bool added;
+    *d_names.insert(name, item.brigOffset(), added) = item.brigOffset();
+    return added;
 }
 
 } // namespace HSAIL_ASM
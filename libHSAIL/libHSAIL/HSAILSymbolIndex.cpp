@@ -0,0 +1,279 @@
+// University of Illinois/NCSA
+// Open Source License
+//
+// Copyright (c) 2013-2015, Advanced Micro Devices, Inc.
+// All rights reserved.
+//
+// Developed by:
+//
+//     HSA Team
+//
+//     Advanced Micro Devices, Inc
+//
+//     www.amd.com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the "Software"), to deal with
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+//     * Redistributions of source code must retain the above copyright notice,
+//       this list of conditions and the following disclaimers.
+//
+//     * Redistributions in binary form must reproduce the above copyright notice,
+//       this list of conditions and the following disclaimers in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the names of the LLVM Team, University of Illinois at
+//       Urbana-Champaign, nor the names of its contributors may be used to
+//       endorse or promote products derived from this Software without specific
+//       prior written permission.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS WITH THE
+// SOFTWARE.
+#include "HSAILSymbolIndex.h"
+#include "HSAILItems.h"
+
+#include <algorithm>
+#include <cstring>
+#include <set>
+#include <vector>
+
+namespace HSAIL_ASM
+{
+
+namespace {
+
+struct IndexedSymbol {
+    uint32_t         hash;
+    uint32_t         bucket;
+    SymbolIndexEntry entry;
+
+    bool operator<(const IndexedSymbol& other) const { return bucket < other.bucket; }
+};
+
+template <typename Dir>
+void addSymbol(std::vector<IndexedSymbol>& syms, std::set<SRef>& seen, Dir d)
+{
+    SRef const name = d.name();
+    if (!seen.insert(name).second) return; // the first declaration wins
+
+    IndexedSymbol s;
+    s.hash = symbolIndexHash(name);
+    s.bucket = 0;
+    s.entry.name = d.name().deref();
+    s.entry.code = d.brigOffset();
+    s.entry.kind = d.kind();
+    s.entry.linkage = d.linkage();
+    s.entry.reserved = 0;
+    syms.push_back(s);
+}
+
+uint32_t pow2Ceil(uint32_t v)
+{
+    uint32_t p = 1;
+    while (p < v) p <<= 1;
+    return p;
+}
+
+template <typename T>
+void append(std::vector<char>& buf, const T& v)
+{
+    buf.insert(buf.end(), (const char*)&v, (const char*)(&v + 1));
+}
+
+BrigSectionImpl* symbolIndexSection(BrigContainer& c)
+{
+    return const_cast<BrigSectionImpl*>(findSymbolIndexSection(c));
+}
+
+SRef sectionName(const BrigSectionImpl& s)
+{
+    const BrigSectionHeader* h = s.secHeader();
+    return SRef((const char*)h->name, (const char*)h->name + h->nameLength);
+}
+
+// string of the data section at the offset, false if it is out of range
+bool dataString(const DataSection& strings, Offset offset, SRef& res)
+{
+    Offset const strSize = strings.size();
+    if (offset >= strSize || strSize - offset < offsetof(BrigData, bytes)) return false;
+    const BrigData* s = strings.getData<BrigData>(offset);
+    if (s->byteCount > strSize - offset - offsetof(BrigData, bytes)) return false;
+    res = SRef((const char*)s->bytes, (const char*)s->bytes + s->byteCount);
+    return true;
+}
+
+// true if a module scope directive with the name is at the offset of the
+// code section. Both executables and variables start with base and name.
+bool isSymbolAt(const BrigContainer& c, Offset code, uint16_t kind, SRef name)
+{
+    switch(kind) {
+    case BRIG_KIND_DIRECTIVE_KERNEL:
+    case BRIG_KIND_DIRECTIVE_FUNCTION:
+    case BRIG_KIND_DIRECTIVE_INDIRECT_FUNCTION:
+    case BRIG_KIND_DIRECTIVE_SIGNATURE:
+    case BRIG_KIND_DIRECTIVE_VARIABLE:
+        break;
+    default:
+        return false;
+    }
+    Offset const codeSize = c.code().size();
+    if (code < c.code().secHeader()->headerByteCount || (code & 0x3) != 0 ||
+        code >= codeSize || codeSize - code < sizeof(BrigDirectiveVariable)) return false;
+    const BrigDirectiveVariable* d = c.code().getData<BrigDirectiveVariable>(code);
+    uint16_t const minSize = kind == BRIG_KIND_DIRECTIVE_VARIABLE ? sizeof(BrigDirectiveVariable)
+                                                                   : sizeof(BrigDirectiveExecutable);
+    if (d->base.kind != kind || d->base.byteCount < minSize || d->base.byteCount > codeSize - code) return false;
+    SRef dirName;
+    return dataString(c.strings(), d->name, dirName) && dirName == name;
+}
+
+// the index comes from a file and may be stale or damaged, so everything is
+// bounds-checked and the hit is checked against the code section. Returns
+// false if the name is not found by the index or the index cannot be used.
+bool lookupSymbolIndex(const BrigSectionImpl& idx, const BrigContainer& c, SRef name, Offset& res)
+{
+    res = 0;
+
+    uint64_t const hdrSize = idx.secHeader()->headerByteCount;
+    uint64_t const secSize = idx.size();
+    if ((hdrSize & 0x3) != 0 || secSize < hdrSize + sizeof(SymbolIndexHeader)) return false;
+
+    const SymbolIndexHeader* h = idx.getData<SymbolIndexHeader>((Offset)hdrSize);
+    uint32_t const n = h->symbolCount;
+    if (h->bucketCount == 0 || h->bloomWordCount == 0 ||
+        (h->bloomWordCount & (h->bloomWordCount - 1)) != 0 || h->bloomShift >= 32) return false;
+    uint64_t const size = sizeof(SymbolIndexHeader) +
+        sizeof(uint32_t) * ((uint64_t)h->bloomWordCount + h->bucketCount + n) + sizeof(SymbolIndexEntry) * (uint64_t)n;
+    if (size > secSize - hdrSize) return false;
+
+    const uint32_t* bloom   = (const uint32_t*)(h + 1);
+    const uint32_t* buckets = bloom + h->bloomWordCount;
+    const uint32_t* chain   = buckets + h->bucketCount;
+    const SymbolIndexEntry* entries = (const SymbolIndexEntry*)(chain + n);
+
+    uint32_t const hash = symbolIndexHash(name);
+    uint32_t const word = bloom[(hash / 32) & (h->bloomWordCount - 1)];
+    if (((word >> (hash % 32)) & (word >> ((hash >> h->bloomShift) % 32)) & 1) == 0) return false;
+
+    uint32_t i = buckets[hash % h->bucketCount];
+    if (i == SYMBOL_INDEX_NO_ENTRY) return false;
+
+    for(; i < n; ++i) {
+        if ((chain[i] | 1) == (hash | 1)) {
+            const SymbolIndexEntry& e = entries[i];
+            SRef entryName;
+            if (!dataString(c.strings(), e.name, entryName)) return false;
+            if (entryName == name) {
+                if (!isSymbolAt(c, e.code, e.kind, name)) return false;
+                res = e.code;
+                return true;
+            }
+        }
+        if (chain[i] & 1) return false;
+    }
+    return false; // chain is not terminated
+}
+
+} // namespace
+
+void buildSymbolIndex(BrigContainer& c)
+{
+    assert(c.isRWContainer());
+
+    std::vector<IndexedSymbol> syms;
+    std::set<SRef> seen;
+    for (Code d = c.code().begin(), e = c.code().end(); d != e; ) {
+        if (DirectiveExecutable x = d) {
+            addSymbol(syms, seen, x);
+            d = x.nextModuleEntry();
+        } else if (DirectiveVariable v = d) {
+            addSymbol(syms, seen, v);
+            d = d.next();
+        } else {
+            d = d.next();
+        }
+    }
+
+    SymbolIndexHeader h;
+    h.symbolCount = (uint32_t)syms.size();
+    h.bucketCount = h.symbolCount / 2 + 1;
+    h.bloomWordCount = pow2Ceil(h.symbolCount / 4 + 1); // about 8 bits per symbol
+    h.bloomShift = SYMBOL_INDEX_BLOOM_SHIFT;
+
+    std::vector<uint32_t> bloom(h.bloomWordCount, 0);
+    std::vector<uint32_t> buckets(h.bucketCount, SYMBOL_INDEX_NO_ENTRY);
+    for(size_t i = 0; i < syms.size(); ++i) {
+        uint32_t const hash = syms[i].hash;
+        syms[i].bucket = hash % h.bucketCount;
+        bloom[(hash / 32) & (h.bloomWordCount - 1)] |= (1u << (hash % 32)) | (1u << ((hash >> h.bloomShift) % 32));
+    }
+    std::stable_sort(syms.begin(), syms.end());
+
+    std::vector<char> payload;
+    append(payload, h);
+    payload.insert(payload.end(), (const char*)&bloom[0], (const char*)(&bloom[0] + bloom.size()));
+    size_t const bucketsPos = payload.size();
+    payload.insert(payload.end(), (const char*)&buckets[0], (const char*)(&buckets[0] + buckets.size()));
+    for(size_t i = 0; i < syms.size(); ++i) {
+        bool const last = i + 1 == syms.size() || syms[i + 1].bucket != syms[i].bucket;
+        if (i == 0 || syms[i - 1].bucket != syms[i].bucket) {
+            uint32_t const first = (uint32_t)i;
+            memcpy(&payload[bucketsPos + syms[i].bucket * sizeof(uint32_t)], &first, sizeof first);
+        }
+        append(payload, (uint32_t)((syms[i].hash & ~1u) | (last ? 1u : 0u)));
+    }
+    for(size_t i = 0; i < syms.size(); ++i) {
+        append(payload, syms[i].entry);
+    }
+
+    BrigSectionImpl* sec = symbolIndexSection(c);
+    if (sec) {
+        sec->clear();
+    } else {
+        std::unique_ptr<BrigSectionImpl> s(new BrigSectionRaw(SRef(SYMBOL_INDEX_SECTION_NAME)));
+        sec = s.get();
+        c.addSection(std::move(s));
+    }
+    sec->insertData(sec->size(), &payload[0], &payload[0] + payload.size());
+}
+
+const BrigSectionImpl* findSymbolIndexSection(const BrigContainer& c)
+{
+    for(int i = BRIG_SECTION_INDEX_IMPLEMENTATION_DEFINED; i < c.getNumSections(); ++i) {
+        const BrigSectionImpl& s = c.sectionById(i);
+        if (sectionName(s) == SYMBOL_INDEX_SECTION_NAME) return &s;
+    }
+    return NULL;
+}
+
+Offset findModuleSymbol(BrigContainer& c, SRef name)
+{
+    if (const BrigSectionImpl* idx = findSymbolIndexSection(c)) {
+        Offset res;
+        if (lookupSymbolIndex(*idx, c, name, res)) return res;
+    }
+
+    for (Code d = c.code().begin(), e = c.code().end(); d != e; ) {
+        if (DirectiveExecutable x = d) {
+            if (SRef(x.name()) == name) { return x.brigOffset(); }
+            d = x.nextModuleEntry(); // Skip to next top level directive.
+        } else if (DirectiveVariable v = d) {
+            if (SRef(v.name()) == name) { return v.brigOffset(); }
+            d = d.next(); // Skip to next directive.
+        } else {
+            d = d.next(); // Skip to next directive.
+        }
+    }
+    return 0;
+}
+
+}
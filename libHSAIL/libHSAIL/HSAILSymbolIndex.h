@@ -0,0 +1,113 @@
+// University of Illinois/NCSA
+// Open Source License
+//
+// Copyright (c) 2013-2015, Advanced Micro Devices, Inc.
+// All rights reserved.
+//
+// Developed by:
+//
+//     HSA Team
+//
+//     Advanced Micro Devices, Inc
+//
+//     www.amd.com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the "Software"), to deal with
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+//     * Redistributions of source code must retain the above copyright notice,
+//       this list of conditions and the following disclaimers.
+//
+//     * Redistributions in binary form must reproduce the above copyright notice,
+//       this list of conditions and the following disclaimers in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the names of the LLVM Team, University of Illinois at
+//       Urbana-Champaign, nor the names of its contributors may be used to
+//       endorse or promote products derived from this Software without specific
+//       prior written permission.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS WITH THE
+// SOFTWARE.
+#pragma once
+#ifndef INCLUDED_HSAIL_SYMBOL_INDEX_H
+#define INCLUDED_HSAIL_SYMBOL_INDEX_H
+
+#include "HSAILBrigContainer.h"
+
+namespace HSAIL_ASM
+{
+
+/// Symbol index is an optional implementation defined section which maps
+/// names of module scope symbols to their offsets in the code section.
+/// The layout follows the GNU ELF hash table: a bloom filter rejects most
+/// of the missing names, and symbols are grouped by buckets so that each
+/// bucket is a contiguous run of entries terminated by a chain word with
+/// the lowest bit set. Names are not copied, entries refer to hsa_data.
+///
+/// Payload of the section (all fields are 32-bit):
+///   SymbolIndexHeader
+///   uint32_t          bloom[bloomWordCount]
+///   uint32_t          buckets[bucketCount]   first entry of the bucket or SYMBOL_INDEX_NO_ENTRY
+///   uint32_t          chain[symbolCount]     name hash, lowest bit marks the last entry of a bucket
+///   SymbolIndexEntry  entries[symbolCount]
+
+#define SYMBOL_INDEX_SECTION_NAME "hsa_symbols"
+
+enum {
+    SYMBOL_INDEX_NO_ENTRY = 0xFFFFFFFF,
+    SYMBOL_INDEX_BLOOM_SHIFT = 5
+};
+
+struct SymbolIndexHeader {
+    uint32_t bucketCount;
+    uint32_t symbolCount;
+    uint32_t bloomWordCount; // power of 2
+    uint32_t bloomShift;
+};
+
+struct SymbolIndexEntry {
+    uint32_t name;   // offset of the name in hsa_data
+    uint32_t code;   // offset of the directive in hsa_code
+    uint16_t kind;   // BrigKind of the directive
+    uint8_t  linkage;
+    uint8_t  reserved;
+};
+
+/// hash function of the index (the one used by GNU hash style ELF tables)
+inline uint32_t symbolIndexHash(SRef name) {
+    uint32_t h = 5381;
+    for(const char* p = name.begin; p != name.end; ++p) {
+        h = h * 33 + (unsigned char)*p;
+    }
+    return h;
+}
+
+/// builds the index of module scope symbols (kernels, functions, signatures
+/// and variables) and stores it in the container, replacing the previous
+/// index. The index must be rebuilt if the code section is changed
+/// afterwards. The container must be writeable.
+void buildSymbolIndex(BrigContainer& c);
+
+/// returns the symbol index section of the container or NULL
+const BrigSectionImpl* findSymbolIndexSection(const BrigContainer& c);
+
+/// returns the offset of the first module scope directive with the specified
+/// name (including the leading '&'), or 0 if there is none. A directive found
+/// by the symbol index is checked to have the name; if it is not, or the
+/// index is missing, damaged or does not have the name, the code section is
+/// walked.
+Offset findModuleSymbol(BrigContainer& c, SRef name);
+
+}
+
+#endif
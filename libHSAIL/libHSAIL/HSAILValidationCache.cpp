@@ -0,0 +1,381 @@
+// University of Illinois/NCSA
+// Open Source License
+//
+// Copyright (c) 2013-2015, Advanced Micro Devices, Inc.
+// All rights reserved.
+//
+// Developed by:
+//
+//     HSA Team
+//
+//     Advanced Micro Devices, Inc
+//
+//     www.amd.com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the "Software"), to deal with
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+//     * Redistributions of source code must retain the above copyright notice,
+//       this list of conditions and the following disclaimers.
+//
+//     * Redistributions in binary form must reproduce the above copyright notice,
+//       this list of conditions and the following disclaimers in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the names of the LLVM Team, University of Illinois at
+//       Urbana-Champaign, nor the names of its contributors may be used to
+//       endorse or promote products derived from this Software without specific
+//       prior written permission.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS WITH THE
+// SOFTWARE.
+#include "HSAILValidationCache.h"
+
+#include <cassert>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <vector>
+
+namespace HSAIL_ASM
+{
+
+namespace {
+
+enum {
+    VALIDATION_CACHE_VERSION = 1, // must be changed along with validation rules
+    MAX_OPERAND_DEPTH = 8         // deeper operands are not expected, maybe a cycle
+};
+
+const char VALIDATION_CACHE_MAGIC[8] = { 'H', 'S', 'A', 'I', 'L', 'V', 'C', '\0' };
+
+// tags which tell apart hashed references
+const uint64_t REF_NONE     = 0;
+const uint64_t REF_INTERNAL = 1ull << 32;
+const uint64_t REF_EXTERNAL = 2ull << 32;
+const uint64_t REF_OPERAND  = 3ull << 32;  // followed by the hash of the operand
+
+inline uint64_t rotl(uint64_t x, unsigned r) { return (x << r) | (x >> (64 - r)); }
+
+// word at a time variant of the MurmurHash3 mixing with the 64-bit finalizer
+class HashBuilder
+{
+    uint64_t m_h;
+
+public:
+    explicit HashBuilder(uint64_t seed) : m_h(seed ^ 0x9E3779B97F4A7C15ull) {}
+
+    void add(uint64_t v)
+    {
+        v *= 0x87C37B91114253D5ull;
+        v = rotl(v, 31);
+        v *= 0x4CF5AD432745937Full;
+        m_h = rotl(m_h ^ v, 27) * 5 + 0x52DCE729;
+    }
+
+    void add(SRef s)
+    {
+        add((uint64_t)s.length());
+        const char* p = s.begin;
+        for(; s.end - p >= 8; p += 8) {
+            uint64_t v;
+            memcpy(&v, p, 8);
+            add(v);
+        }
+        if (p != s.end) {
+            uint64_t v = 0;
+            memcpy(&v, p, s.end - p);
+            add(v);
+        }
+    }
+
+    uint64_t result() const
+    {
+        uint64_t h = m_h;
+        h ^= h >> 33;
+        h *= 0xFF51AFD7ED558CCDull;
+        h ^= h >> 33;
+        h *= 0xC4CEB9FE1A85EC53ull;
+        h ^= h >> 33;
+        return h;
+    }
+};
+
+// field visitor (see enumerateFields) which adds an item to the hash
+class ItemHasher
+{
+    BrigContainer&                          m_brig;
+    uint64_t const                          m_seed;
+    Offset const                            m_start;    // code range of the executable
+    Offset const                            m_end;
+    std::vector<uint64_t>&                  m_operandHashes;
+
+    HashBuilder* m_hash;
+    Offset       m_base;        // code offsets are hashed relative to it
+    bool         m_shallow;     // references of a declaration outside of the range are not followed
+    bool         m_refersCode;  // the operand being hashed refers to code
+    unsigned     m_depth;
+    bool         m_ok;
+
+public:
+    ItemHasher(DirectiveExecutable d, uint64_t seed, std::vector<uint64_t>& operandHashes, HashBuilder& hash)
+        : m_brig(*d.container())
+        , m_seed(seed)
+        , m_start(d.brigOffset())
+        , m_end(d.nextModuleEntry().brigOffset())
+        , m_operandHashes(operandHashes)
+        , m_hash(&hash)
+        , m_base(d.brigOffset())
+        , m_shallow(false)
+        , m_refersCode(false)
+        , m_depth(0)
+        , m_ok(true) {}
+
+    bool ok() const { return m_ok; }
+
+    void addItem(Code c)
+    {
+        m_hash->add(c.kind());
+        m_hash->add(c.byteCount());
+        enumerateFields(c, *this);
+    }
+
+    template <typename T>
+    void operator()(T value, const char*) { m_hash->add((uint64_t)value); }
+
+    void operator()(StrRef s, const char*) { m_hash->add(SRef(s)); }
+
+    template <typename I>
+    void operator()(ItemRef<I> ref, const char*) { addRef(ref.deref(), I::SECTION); }
+
+    template <typename I>
+    void operator()(ListRef<I> list, const char*)
+    {
+        int const size = list.size();
+        m_hash->add((uint64_t)size);
+        for(int i = 0; i < size; ++i) addRef(list[i].brigOffset(), I::SECTION);
+    }
+
+private:
+    void addRef(Offset offset, int section)
+    {
+        if (offset == 0) {
+            m_hash->add(REF_NONE);
+        } else if (section == BRIG_SECTION_INDEX_OPERAND) {
+            if (m_shallow) m_hash->add(REF_OPERAND);
+            else           addOperand(offset);
+        } else if (m_shallow || (m_start <= offset && offset <= m_end)) {
+            m_hash->add(REF_INTERNAL | (Offset)(offset - m_base));
+        } else {
+            addExternal(offset);
+        }
+    }
+
+    void addOperand(Offset offset)
+    {
+        uint64_t& memo = m_operandHashes[offset / 4];
+        if (memo != 0) {
+            m_hash->add(REF_OPERAND);
+            m_hash->add(memo);
+            return;
+        }
+        if (m_depth == MAX_OPERAND_DEPTH) {
+            m_ok = false;
+            return;
+        }
+
+        HashBuilder h(m_seed);
+        HashBuilder* const outer = m_hash;
+        bool const outerRefersCode = m_refersCode;
+        m_hash = &h;
+        m_refersCode = false;
+        ++m_depth;
+
+        Operand o(&m_brig, offset);
+        h.add(o.kind());
+        h.add(o.byteCount());
+        enumerateFields(o, *this);
+
+        --m_depth;
+        m_hash = outer;
+        uint64_t const res = h.result() | 1; // 0 is not computed
+        m_hash->add(REF_OPERAND);
+        m_hash->add(res);
+        // hashes of operands referring to code depend on the executable
+        if (!m_refersCode && m_ok) m_operandHashes[offset / 4] = res;
+        m_refersCode |= outerRefersCode;
+    }
+
+    // module scope symbols are hashed by their declarations
+    void addExternal(Offset offset)
+    {
+        m_refersCode = true;
+
+        Code c(&m_brig, offset);
+        if (DirectiveModule(c)) {
+            m_hash->add(REF_EXTERNAL);
+            addShallow(c);
+            return;
+        }
+        SRef name;
+        if      (DirectiveVariable v = c)   name = v.name();
+        else if (DirectiveFbarrier f = c)   name = f.name();
+        else if (DirectiveExecutable e = c) name = e.name();
+        if (name.empty() || name[0] != '&') {
+            m_ok = false;
+            return;
+        }
+
+        m_hash->add(REF_EXTERNAL);
+        addShallow(c);
+        if (DirectiveExecutable e = c) {
+            Offset const end = e.nextModuleEntry().brigOffset();
+            if (end <= offset) {
+                m_ok = false;
+                return;
+            }
+            Code arg = e.next();
+            for(unsigned n = e.outArgCount() + e.inArgCount(); n > 0; --n, arg = arg.next()) {
+                if (arg.brigOffset() >= end) {
+                    m_ok = false;
+                    return;
+                }
+                addShallow(arg, offset);
+            }
+        }
+    }
+
+    void addShallow(Code c, Offset base = 0)
+    {
+        Offset const outerBase = m_base;
+        m_base = base ? base : c.brigOffset();
+        m_shallow = true;
+        addItem(c);
+        m_shallow = false;
+        m_base = outerBase;
+    }
+};
+
+} // namespace
+
+void ExecutableHasher::addModuleProperty(uint64_t value)
+{
+    assert(m_operandHashes.empty());
+    HashBuilder h(m_seed);
+    h.add(value);
+    m_seed = h.result();
+}
+
+void ExecutableHasher::addModuleProperty(SRef value)
+{
+    assert(m_operandHashes.empty());
+    HashBuilder h(m_seed);
+    h.add(value);
+    m_seed = h.result();
+}
+
+bool ExecutableHasher::hash(DirectiveExecutable d, uint64_t& res)
+{
+    Offset const end = d.nextModuleEntry().brigOffset();
+    if (end <= d.brigOffset()) return false;
+
+    if (m_operandHashes.empty()) m_operandHashes.resize(d.container()->operands().size() / 4 + 1);
+
+    HashBuilder h(m_seed);
+    ItemHasher hasher(d, m_seed, m_operandHashes, h);
+    for(Code c = d; c.brigOffset() < end; c = c.next()) {
+        hasher.addItem(c);
+    }
+    res = h.result();
+    return hasher.ok();
+}
+
+//============================================================================
+
+ValidationCache::ValidationCache()
+{
+    std::random_device rd;
+    m_seed = ((uint64_t)rd() << 32) | rd();
+}
+
+size_t ValidationCache::size() const
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    return m_keys.size();
+}
+
+bool ValidationCache::contains(uint64_t key) const
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    return m_keys.count(key) != 0;
+}
+
+void ValidationCache::insert(uint64_t key)
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    m_keys.insert(key);
+}
+
+// File layout: magic, uint32_t version, uint32_t reserved, uint64_t seed,
+// uint64_t number of keys, then the keys. Native byte order.
+bool ValidationCache::load(const std::string& fileName)
+{
+    std::ifstream f(fileName.c_str(), std::ios::binary);
+    char magic[sizeof VALIDATION_CACHE_MAGIC];
+    uint32_t version[2];
+    uint64_t seed, count;
+    if (!f.read(magic, sizeof magic) ||
+        !f.read((char*)version, sizeof version) ||
+        !f.read((char*)&seed, sizeof seed) ||
+        !f.read((char*)&count, sizeof count)) return false;
+    if (memcmp(magic, VALIDATION_CACHE_MAGIC, sizeof magic) != 0 ||
+        version[0] != VALIDATION_CACHE_VERSION || count > (1ull << 32)) return false;
+
+    // the keys must be in the file before they are allocated for
+    std::streamoff const keysStart = f.tellg();
+    if (keysStart < 0 || !f.seekg(0, std::ios::end)) return false;
+    std::streamoff const keysEnd = f.tellg();
+    if (keysEnd < keysStart || (uint64_t)(keysEnd - keysStart) < count * sizeof(uint64_t) ||
+        !f.seekg(keysStart)) return false;
+
+    std::vector<uint64_t> keys((size_t)count);
+    if (count > 0 && !f.read((char*)&keys[0], keys.size() * sizeof(uint64_t))) return false;
+
+    std::lock_guard<std::mutex> lock(m_lock);
+    m_seed = seed;
+    m_keys.clear();
+    m_keys.insert(keys.begin(), keys.end());
+    return true;
+}
+
+bool ValidationCache::save(const std::string& fileName) const
+{
+    std::vector<uint64_t> keys;
+    uint64_t seed;
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        keys.assign(m_keys.begin(), m_keys.end());
+        seed = m_seed;
+    }
+    uint32_t const version[2] = { VALIDATION_CACHE_VERSION, 0 };
+    uint64_t const count = keys.size();
+
+    std::ofstream f(fileName.c_str(), std::ios::binary | std::ios::trunc);
+    f.write(VALIDATION_CACHE_MAGIC, sizeof VALIDATION_CACHE_MAGIC);
+    f.write((const char*)version, sizeof version);
+    f.write((const char*)&seed, sizeof seed);
+    f.write((const char*)&count, sizeof count);
+    if (count > 0) f.write((const char*)&keys[0], keys.size() * sizeof(uint64_t));
+    return (bool)f.flush();
+}
+
+}
@@ -0,0 +1,121 @@
+// University of Illinois/NCSA
+// Open Source License
+//
+// Copyright (c) 2013-2015, Advanced Micro Devices, Inc.
+// All rights reserved.
+//
+// Developed by:
+//
+//     HSA Team
+//
+//     Advanced Micro Devices, Inc
+//
+//     www.amd.com
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the "Software"), to deal with
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+//     * Redistributions of source code must retain the above copyright notice,
+//       this list of conditions and the following disclaimers.
+//
+//     * Redistributions in binary form must reproduce the above copyright notice,
+//       this list of conditions and the following disclaimers in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the names of the LLVM Team, University of Illinois at
+//       Urbana-Champaign, nor the names of its contributors may be used to
+//       endorse or promote products derived from this Software without specific
+//       prior written permission.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS WITH THE
+// SOFTWARE.
+#pragma once
+#ifndef INCLUDED_HSAIL_VALIDATION_CACHE_H
+#define INCLUDED_HSAIL_VALIDATION_CACHE_H
+
+#include "HSAILItems.h"
+
+#include <mutex>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+namespace HSAIL_ASM
+{
+
+/// Set of kernels and functions already proven valid, identified by keys
+/// combining a structural hash of the executable (see ExecutableHasher)
+/// with the machine model, profile and extensions of the module. The
+/// validator skips checks of executables found in the cache, see
+/// Validator::setCache. The cache may be shared by validators running
+/// on several threads.
+///
+/// Hashes are seeded with a random value chosen when the cache is created
+/// and kept in the cache file, so that keys of a cache are hard to guess.
+/// Still, the hash is not cryptographic and a cache should only be used
+/// with modules which come from trusted producers.
+class ValidationCache
+{
+    mutable std::mutex           m_lock;
+    uint64_t                     m_seed;
+    std::unordered_set<uint64_t> m_keys;
+
+    ValidationCache(const ValidationCache&); // non-copyable
+    const ValidationCache &operator=(const ValidationCache &); // not assignable
+
+public:
+    ValidationCache();
+
+    uint64_t seed() const { return m_seed; }
+    size_t size() const;
+
+    bool contains(uint64_t key) const;
+    void insert(uint64_t key);
+
+    /// replaces the contents with the cache stored in the file. Returns false
+    /// (and leaves the cache unchanged) if the file cannot be read, is damaged
+    /// or has been saved by another version of the validator.
+    bool load(const std::string& fileName);
+
+    /// returns false if the file cannot be written.
+    bool save(const std::string& fileName) const;
+};
+
+/// Computes structural hashes of kernels, functions and signatures: the
+/// directive, its arguments and body, operands they refer to and contents
+/// of strings. Offsets of code items inside the executable are hashed
+/// relative to it, and module scope symbols referred to from outside the
+/// executable are hashed by their declarations (and arguments for
+/// functions). Hashes of the operands are memoized, so a hasher should
+/// be used for a single module.
+class ExecutableHasher
+{
+    uint64_t              m_seed;
+    std::vector<uint64_t> m_operandHashes; // by operand offset / 4, of operands which do not refer to code
+
+public:
+    explicit ExecutableHasher(uint64_t seed) : m_seed(seed) {}
+
+    /// properties of the module which affect validation of executables
+    /// (version, machine model, profile, extensions) are added to the
+    /// seed before hashing the first executable.
+    void addModuleProperty(uint64_t value);
+    void addModuleProperty(SRef value);
+
+    /// returns false if the executable refers to anything but module scope
+    /// symbols outside of its code range, such executables are not cached.
+    bool hash(DirectiveExecutable d, uint64_t& res);
+};
+
+}
+
+#endif
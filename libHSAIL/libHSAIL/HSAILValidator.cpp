@@ -42,13 +42,18 @@
 
 #include "HSAILValidatorBase.h"
 #include "HSAILValidator.h"
+#include "HSAILValidationCache.h"
 #include "HSAILDisassembler.h"
 #include "HSAILScanner.h" // using SyntaxError utilities
+#include "HSAILSymbolIndex.h" // using symbolIndexHash
 #include "HSAILItems.h"
 #include "HSAILUtilities.h"
 #include "Brig.h"
 
 #include <ctype.h>
+#include <atomic>
+#include <chrono>
+#include <iomanip>
 #include <iosfwd>
 #include <sstream>
 #include <vector>
@@ -56,6 +61,7 @@
 #include <functional>
 #include <set>
 #include <map>
+#include <thread>
 
 using std::map;
 using std::set;
@@ -85,6 +91,7 @@ class BrigFormatError
 public:
     static const int ERRCODE_STD  = 100; // Generic Validator error code
     static const int ERRCODE_INST = 101; // Instruction Validator error code
+    static const int ERRCODE_LINK = 102; // Program linkage error code
 
 private:
     string msg;
@@ -525,6 +532,103 @@ public: // Brig Object Properties
         else return d.next();
     }
 
+public: // Compatibility of declarations and definitions of the same symbol
+
+    static bool eqDecl(Code d1, Code d2)
+    {
+        assert(d1.kind() == d2.kind());
+
+        if (isVar(d1))
+        {
+            return eqSymDecl(d1, d2);
+        }
+        else if (isFbar(d1))
+        {
+            return eqFbarDecl(d1, d2);
+        }
+        else if (isSbr(d1))
+        {
+            return eqSbrDecl(d1, d2);
+        }
+        else if (isSignature(d1))
+        {
+            return false;
+        }
+        else
+        {
+            assert(false);
+            return false;
+        }
+    }
+
+    // Module declarations are compatible only with Module declarations and definitions
+    // Program declarations are compatible only with program declarations and definitions (this is checked elsewhere)
+    static bool eqSbrDecl(Code sbr1, Code sbr2)
+    {
+        if (getSymLinkage(sbr1) != getSymLinkage(sbr2)) return false;
+
+        if (getInParamNum(sbr1)  == getInParamNum(sbr2) &&
+            getOutParamNum(sbr1) == getOutParamNum(sbr2))
+        {
+            Code arg1 = sbr1.next();
+            Code arg2 = sbr2.next();
+
+            for (unsigned i = getParamNum(sbr1); i > 0; --i)
+            {
+                if (!eqSymDecl(arg1, arg2, true)) return false;
+
+                arg1 = arg1.next();
+                arg2 = arg2.next();
+            }
+            return true;
+        }
+        return false;
+    }
+
+    static bool eqSymDecl(DirectiveVariable var1, DirectiveVariable var2, bool isArg = false)
+    {
+        if (var1.kind()        != var2.kind()       ||
+            var1.type()        != var2.type()       ||
+            getSegment(var1)   != getSegment(var2)  ||
+            getAlignment(var1) != getAlignment(var2)) return false;
+
+        if (isArg && getArraySize(var1) != getArraySize(var2)) return false; //F1.0 could it be removed?
+
+        if (isConst(var1) != isConst(var2) ||
+            isArray(var1) != isArray(var2))
+            return false;
+
+        // NB: linkage and allocation rules for formal arguments are different
+        //     for function/kernel definitions and declarations.
+        //     These rules are validated elsewhere
+        if (!isArg)
+        {
+            if (var1.allocation()   != var2.allocation())   return false;
+            if (getSymLinkage(var1) != getSymLinkage(var2)) return false;
+        }
+
+        if (isArray(var1) && !isArgSeg(var1) && !isKernArgSeg(var1))
+        {
+            // Special rules for non-argument arrays. Specification states:
+            //     "If the object is an array, the size of the array must be specified
+            //      in the definition but can be omitted in the declaration."
+            // This rule does not apply to symbols declared/defined in Arg/Kernarg segments
+            return getArraySize(var1) == 0 ||
+                   getArraySize(var2) == 0 ||
+                   getArraySize(var1) == getArraySize(var2);
+        }
+
+        // for arguments and non-arrays, arg1.dim must be the same as arg2.dim
+
+        return getArraySize(var1) == getArraySize(var2);
+
+        // NB: other attributes are irrelevant (for declarations)
+    }
+
+    static bool eqFbarDecl(DirectiveFbarrier arg1, DirectiveFbarrier arg2)
+    {
+        return arg1.kind() == arg2.kind() && getSymLinkage(arg1) == getSymLinkage(arg2);
+    }
 };
 
 //=============================================================================
@@ -1266,102 +1370,6 @@ private:
         }
     }
 
-    bool eqDecl(Code d1, Code d2)
-    {
-        assert(d1.kind() == d2.kind());
-
-        if (isVar(d1))
-        {
-            return eqSymDecl(d1, d2);
-        }
-        else if (isFbar(d1))
-        {
-            return eqFbarDecl(d1, d2);
-        }
-        else if (isSbr(d1))
-        {
-            return eqSbrDecl(d1, d2);
-        }
-        else if (isSignature(d1))
-        {
-            return false;
-        }
-        else
-        {
-            assert(false);
-            return false;
-        }
-    }
-
-    // Module declarations are compatible only with Module declarations and definitions
-    // Program declarations are compatible only with program declarations and definitions (this is checked elsewhere)
-    bool eqSbrDecl(Code sbr1, Code sbr2)
-    {
-        if (getSymLinkage(sbr1) != getSymLinkage(sbr2)) return false;
-
-        if (getInParamNum(sbr1)  == getInParamNum(sbr2) &&
-            getOutParamNum(sbr1) == getOutParamNum(sbr2))
-        {
-            Code arg1 = sbr1.next();
-            Code arg2 = sbr2.next();
-
-            for (unsigned i = getParamNum(sbr1); i > 0; --i)
-            {
-                if (!eqSymDecl(arg1, arg2, true)) return false;
-
-                arg1 = arg1.next();
-                arg2 = arg2.next();
-            }
-            return true;
-        }
-        return false;
-    }
-
-    bool eqSymDecl(DirectiveVariable var1, DirectiveVariable var2, bool isArg = false) const
-    {
-        if (var1.kind()        != var2.kind()       ||
-            var1.type()        != var2.type()       ||
-            getSegment(var1)   != getSegment(var2)  ||
-            getAlignment(var1) != getAlignment(var2)) return false;
-
-        if (isArg && getArraySize(var1) != getArraySize(var2)) return false; //F1.0 could it be removed?
-
-        if (isConst(var1) != isConst(var2) ||
-            isArray(var1) != isArray(var2))
-            return false;
-
-        // NB: linkage and allocation rules for formal arguments are different
-        //     for function/kernel definitions and declarations.
-        //     These rules are validated elsewhere
-        if (!isArg)
-        {
-            if (var1.allocation()   != var2.allocation())   return false;
-            if (getSymLinkage(var1) != getSymLinkage(var2)) return false;
-        }
-
-        if (isArray(var1) && !isArgSeg(var1) && !isKernArgSeg(var1))
-        {
-            // Special rules for non-argument arrays. Specification states:
-            //     "If the object is an array, the size of the array must be specified
-            //      in the definition but can be omitted in the declaration."
-            // This rule does not apply to symbols declared/defined in Arg/Kernarg segments
-            return getArraySize(var1) == 0 ||
-                   getArraySize(var2) == 0 ||
-                   getArraySize(var1) == getArraySize(var2);
-        }
-
-        // for arguments and non-arrays, arg1.dim must be the same as arg2.dim
-
-        return getArraySize(var1) == getArraySize(var2);
-
-        // NB: other attributes are irrelevant (for declarations)
-    }
-
-    bool eqFbarDecl(DirectiveFbarrier arg1, DirectiveFbarrier arg2) const
-    {
-        return arg1.kind() == arg2.kind() && getSymLinkage(arg1) == getSymLinkage(arg2);
-    }
-
     void validateModuleDefs()
     {
         // Module symbol must be defined if it is used
@@ -1429,6 +1437,185 @@ private:
     }
 };
 
+//=============================================================================
+//=============================================================================
+//=============================================================================
+// Validation profile
+//
+// Phases and instruction rules are timed by the PROFILE_* macros below,
+// which expand to nothing unless HSAIL_VALIDATOR_PROFILE is defined.
+
+#ifdef HSAIL_VALIDATOR_PROFILE
+
+enum ValidationPhase
+{
+    PHASE_VALIDATE = 0,
+    PHASE_FORMAT,
+    PHASE_FIELDS,
+    PHASE_CODE_FIELDS,
+    PHASE_OPERANDS,
+    PHASE_ITEMS,
+    PHASE_CODE,
+    PHASE_DEFS,
+
+    PHASE_NUM
+};
+
+static const char* phase2str(unsigned phase)
+{
+    switch (phase)
+    {
+    case PHASE_VALIDATE:    return "Validator::validate";
+    case PHASE_FORMAT:      return "validateBrigFormat";
+    case PHASE_FIELDS:      return "validateBrigFields";
+    case PHASE_CODE_FIELDS: return "validateCodeFields";
+    case PHASE_OPERANDS:    return "validateBrigOperands";
+    case PHASE_ITEMS:       return "validateBrigItems";
+    case PHASE_CODE:        return "validateBrigCode";
+    case PHASE_DEFS:        return "validateBrigDefs";
+    default:
+        assert(false);
+        return "";
+    }
+}
+
+class ValidationProfiler
+{
+public:
+    struct Counter
+    {
+        uint64_t calls;
+        std::chrono::steady_clock::duration time;
+
+        Counter() : calls(0), time(0) {}
+    };
+
+    // Adds the time from construction to destruction to a counter
+    class Scope
+    {
+        Counter &counter;
+        std::chrono::steady_clock::time_point start;
+
+    public:
+        explicit Scope(Counter &c) : counter(c), start(std::chrono::steady_clock::now()) {}
+        ~Scope()
+        {
+            ++counter.calls;
+            counter.time += std::chrono::steady_clock::now() - start;
+        }
+    };
+
+private:
+    // core opcodes, then those starting at BRIG_OPCODE_FIRST_USER_DEFINED;
+    // the last counter is shared by all other opcodes
+    static const unsigned OPCODE_RANGE = 256;
+    static const unsigned OTHER_OPCODES = 2 * OPCODE_RANGE;
+
+    Counter phases[PHASE_NUM];
+    Counter opcodes[OTHER_OPCODES + 1];
+
+    static unsigned opcodeIndex(unsigned opcode)
+    {
+        if (opcode < OPCODE_RANGE) return opcode;
+        unsigned const user = opcode - BRIG_OPCODE_FIRST_USER_DEFINED;
+        return user < OPCODE_RANGE ? OPCODE_RANGE + user : OTHER_OPCODES;
+    }
+
+    static unsigned indexOpcode(unsigned idx)
+    {
+        return idx < OPCODE_RANGE ? idx : BRIG_OPCODE_FIRST_USER_DEFINED + idx - OPCODE_RANGE;
+    }
+
+public:
+    Counter& phase(ValidationPhase p) { return phases[p]; }
+    Counter& inst(unsigned opcode)    { return opcodes[opcodeIndex(opcode)]; }
+
+    void clear()
+    {
+        for (unsigned i = 0; i < PHASE_NUM; ++i) phases[i] = Counter();
+        for (unsigned i = 0; i <= OTHER_OPCODES; ++i) opcodes[i] = Counter();
+    }
+
+    void report(ValidationProfile &profile) const
+    {
+        profile.entries.clear();
+        for (unsigned i = 0; i < PHASE_NUM; ++i)
+        {
+            if (phases[i].calls > 0) addEntry(profile, phase2str(i), phases[i]);
+        }
+        for (unsigned i = 0; i <= OTHER_OPCODES; ++i)
+        {
+            if (opcodes[i].calls == 0) continue;
+            const char* name = i < OTHER_OPCODES ? opcode2str(indexOpcode(i)) : "other";
+            ostringstream s;
+            s << "InstValidator::";
+            if (name) s << name; else s << "opcode_" << indexOpcode(i);
+            addEntry(profile, s.str(), opcodes[i]);
+        }
+        std::stable_sort(profile.entries.begin(), profile.entries.end(), longerEntry);
+    }
+
+private:
+    static void addEntry(ValidationProfile &profile, const string &name, const Counter &c)
+    {
+        ValidationProfile::Entry e;
+        e.name    = name;
+        e.calls   = c.calls;
+        e.seconds = std::chrono::duration<double>(c.time).count();
+        profile.entries.push_back(e);
+    }
+
+    static bool longerEntry(const ValidationProfile::Entry &e1, const ValidationProfile::Entry &e2) { return e1.seconds > e2.seconds; }
+};
+
+#define PROFILE_START()       profiler.clear()
+#define PROFILE_PHASE(p)      ValidationProfiler::Scope profilePhase(profiler.phase(p))
+#define PROFILE_INST(opcode)  ValidationProfiler::Scope profileInst(profiler.inst(opcode))
+
+#else
+
+#define PROFILE_START()
+#define PROFILE_PHASE(p)
+#define PROFILE_INST(opcode)
+
+#endif
+
+bool ValidationProfile::isEnabled()
+{
+#ifdef HSAIL_VALIDATOR_PROFILE
+    return true;
+#else
+    return false;
+#endif
+}
+
+void ValidationProfile::printTable(std::ostream& os) const
+{
+    double total = entries.empty()? 0 : entries[0].seconds;
+
+    os << std::setw(12) << "time, ms" << std::setw(8) << "%" << std::setw(12) << "calls" << "  name\n";
+    for (size_t i = 0; i < entries.size(); ++i)
+    {
+        const Entry &e = entries[i];
+        os << std::fixed << std::setprecision(3) << std::setw(12) << e.seconds * 1e3
+           << std::setprecision(1) << std::setw(8) << (total > 0? e.seconds * 100 / total : 0.0)
+           << std::setw(12) << e.calls << "  " << e.name << '\n';
+    }
+    os.unsetf(std::ios::floatfield);
+}
+
+void ValidationProfile::printJson(std::ostream& os) const
+{
+    os << "[";
+    for (size_t i = 0; i < entries.size(); ++i)
+    {
+        const Entry &e = entries[i];
+        os << (i == 0? "\n" : ",\n") << "  { \"name\": \"" << e.name << "\", \"calls\": " << e.calls
+           << ", \"seconds\": " << std::setprecision(9) << e.seconds << " }";
+    }
+    os << "\n]\n";
+}
+
 //=============================================================================
 //=============================================================================
 //=============================================================================
@@ -1442,7 +1629,10 @@ class ValidatorImpl : public BrigHelper
 private:
     BrigContainer &brig;
     vector<unsigned> map[BRIG_NUM_SECTIONS];
+    const vector<unsigned>* itemOffsets[BRIG_NUM_SECTIONS]; // either map or the index of a verified container
     set<Offset> usedInst;
+    Offset      bodyStart;      // instructions of the executable being validated by the fused
+    Offset      bodyEnd;        // traversal start here and end before the next top level statement
 
     bool imageExtEnabled;
     unsigned mModel;
@@ -1452,6 +1642,14 @@ private:
 
     mutable BrigFormatError err;
     bool disasmOnError;
+    bool fusedTraversal;
+    ValidationLevel level;
+    ValidationCache *cache;
+
+#ifdef HSAIL_VALIDATOR_PROFILE
+    mutable ValidationProfiler profiler;
+#endif
+    mutable ValidationProfile profile;
 
     static const int AVR_ITEM_SIZE = 32; //F: customize for each section
 
@@ -1459,24 +1657,62 @@ public:
     //-------------------------------------------------------------------------
     // Public API Implementation
 
-    ValidatorImpl(BrigContainer &c) : brig(c), imageExtEnabled(false), mModel(BRIG_MACHINE_LARGE), mProfile(BRIG_PROFILE_FULL), disasmOnError(false) {}
+    ValidatorImpl(BrigContainer &c) : brig(c), bodyStart(0), bodyEnd(0), imageExtEnabled(false), mModel(BRIG_MACHINE_LARGE), mProfile(BRIG_PROFILE_FULL), disasmOnError(false), fusedTraversal(true), level(VALIDATION_FULL), cache(0) {}
+
+    void setFusedTraversal(bool fused) { fusedTraversal = fused; }
+    void setLevel(ValidationLevel l)   { level = l; }
+    void setCache(ValidationCache *c)  { cache = c; }
+
+    const ValidationProfile& getProfile() const
+    {
+#ifdef HSAIL_VALIDATOR_PROFILE
+        profiler.report(profile);
+#endif
+        return profile;
+    }
 
     bool validate(bool disasm)
     {
         disasmOnError = disasm;
 
+        PROFILE_START();
+        PROFILE_PHASE(PHASE_VALIDATE);
+
         try
         {
+            if (level == VALIDATION_NONE) { err.clear(); return true; }
+
             // Low-level validation
             validateBrigFormat();           // Validation of sections structure
-            validateBrigFields();           // Validation of item field values
 
-            // Version validation
-            initBrigVersion();
+            if (level == VALIDATION_STRUCTURE)
+            {
+                validateBrigFields();       // Validation of item field values
+
+                // Version validation
+                initBrigVersion();
+            }
+            else if (fusedTraversal)
+            {
+                validateCodeFields();       // Validation of code item field values
 
-            // High-level validation
-            validateBrigItems();            // Validation of dependencies between item fields
-            validateBrigDefs();             // Validation of def/use and context
+                // Version validation
+                initBrigVersion();
+
+                validateBrigOperands();     // Operand field values and dependencies
+                validateBrigCode();         // Code item dependencies, def/use and context
+            }
+            else
+            {
+                validateBrigFields();       // Validation of item field values
+
+                // Version validation
+                initBrigVersion();
+
+                // High-level validation
+                validateBrigItems();        // Validation of dependencies between item fields
+                validateBrigDefs();         // Validation of def/use and context
+            }
         }
         catch (BrigFormatError &e)
         {
@@ -1487,7 +1723,7 @@ public:
         return true;
     }
 
-    string getErrorMsg(istream *is) const
+    string getErrorMsg(istream *is, const SourceLineIndex* lines = NULL) const
     {
         if (err.empty()) return "";
 
@@ -1499,11 +1735,15 @@ public:
         {
             return err.what();
         }
-        else if (is && si)
+        else if ((is || lines) && si)
         {
             ostringstream s;
             SrcLoc const srcLoc = { si->line, si->column };
-            printError(s, *is, srcLoc, err.what());
+            if (lines) {
+                printError(s, *lines, srcLoc, err.what());
+            } else {
+                printError(s, *is, srcLoc, err.what());
+            }
             return s.str();
         }
         else
@@ -1521,10 +1761,21 @@ private:
 
     void validateBrigFormat()
     {
+        PROFILE_PHASE(PHASE_FORMAT);
         validateModule();
+
+        // sections of a container loaded by BrigIO::loadVerified
+        // have been walked and checked while reading
+        if (brig.isStructurallyVerified())
+        {
+            for (int section = 0; section < BRIG_NUM_SECTIONS; ++section) itemOffsets[section] = &brig.itemIndex(section);
+            return;
+        }
+
         validateSection(BRIG_SECTION_INDEX_DATA);
         validateSection(BRIG_SECTION_INDEX_CODE);
         validateSection(BRIG_SECTION_INDEX_OPERAND);
+        for (int section = 0; section < BRIG_NUM_SECTIONS; ++section) itemOffsets[section] = &map[section];
     }
 
     //-------------------------------------------------------------------------
@@ -1532,6 +1783,14 @@ private:
 
     void validateBrigFields()
     {
+        PROFILE_PHASE(PHASE_FIELDS);
+        validateCodeFields();
+        validateOperandFields();
+    }
+
+    void validateCodeFields()
+    {
+        PROFILE_PHASE(PHASE_CODE_FIELDS);
         bool versionFound = false;
 
         for(Code code = brig.code().begin(); code != brig.code().end(); code = code.next())
@@ -1564,7 +1823,10 @@ private:
         }
 
         validate(brig.code().begin(), versionFound, "Missing module directive");
+    }
 
+    void validateOperandFields()
+    {
         for(Operand o = brig.operands().begin(); o != brig.operands().end(); o = o.next())
         {
             validate(o, ValidateBrigOperandFields(o), "Invalid operand kind");
@@ -1600,7 +1862,9 @@ private:
 
     void validateBrigItems()
     {
+        PROFILE_PHASE(PHASE_ITEMS);
         InstValidator instValidator(mModel, mProfile);
+        instValidator.enableOperandCheckCache();
 
         for(Code code = brig.code().begin();
             code != brig.code().end();
@@ -1620,15 +1884,200 @@ private:
             code != brig.code().end();
             code = code.next())
         {
-            if (Inst inst = code)
+            if (Inst inst = code) validateInstItem(inst, instValidator);
+        }
+    }
+
+    void validateInstItem(Inst inst, InstValidator &instValidator)
+    {
+        validate(inst, getOperandsNum(inst) <= 5, "Instruction cannot have more than 5 operands");
+
+        if (level < VALIDATION_FULL) return; // instruction rules are not checked
+
+        {
+            PROFILE_INST(inst.opcode());
+            instValidator.validateInst(inst);
+        }
+
+        validateComplexInst(inst);
+    }
+
+    //-------------------------------------------------------------------------
+    // Single traversal of each section
+    // NB: the checks are the same as in validateBrigFields, validateBrigItems
+    //     and validateBrigDefs, only the order differs: if a module has
+    //     several errors, the first one found may be another one.
+
+    // Validation of operand fields and of dependencies between them.
+    // An operand is checked when operands it refers to have been field-validated,
+    // that is at once unless the references are forward.
+    void validateBrigOperands()
+    {
+        PROFILE_PHASE(PHASE_OPERANDS);
+        vector<Operand> forward;
+
+        for(Operand o = brig.operands().begin(); o != brig.operands().end(); o = o.next())
+        {
+            validate(o, ValidateBrigOperandFields(o), "Invalid operand kind");
+
+            if (refersForward(o)) forward.push_back(o);
+            else                  validateOperand(o);
+        }
+
+        for (size_t i = 0; i < forward.size(); ++i) validateOperand(forward[i]);
+    }
+
+    bool refersForward(Operand opr) const
+    {
+        if (OperandAddress addr = opr)
+        {
+            return addr.brig()->reg >= opr.brigOffset();
+        }
+        if (OperandConstantOperandList list = opr)
+        {
+            unsigned length = list.elements().size();
+            for (unsigned i = 0; i < length; ++i)
             {
-                validate(inst, getOperandsNum(inst) <= 5, "Instruction cannot have more than 5 operands");
+                if (list.elements()[i].brigOffset() >= opr.brigOffset()) return true;
+            }
+        }
+        return false;
+    }
 
-                instValidator.validateInst(inst);
+    // Validation of dependencies between code item fields and of def/use
+    // one top level statement at a time. Items of the statement are checked
+    // in order, an executable comes before its arguments and body which
+    // makes the instructions of the body known as used.
+    // Executables found in the cache are only checked against the module.
+    void validateBrigCode()
+    {
+        PROFILE_PHASE(PHASE_CODE);
+        InstValidator instValidator(mModel, mProfile);
+        instValidator.enableOperandCheckCache();
+        ValidatorContext context(brig);
+
+        std::unique_ptr<ExecutableHasher> hasher;
+        vector<uint64_t> validated;     // keys of executables to add to the cache
+        if (cache && level == VALIDATION_FULL) hasher = startHashing(*cache);
+
+        analyzeModuleSymbols(context);
+
+        context.startModule();
+
+        Code end = brig.code().end();
+        for (Code code = brig.code().begin(); code != end; )
+        {
+            Code next = isSbr(code)? getNextTopLevel(code) : code.next();
+
+            uint64_t key = 0;
+            bool keyed  = hasher && isSbr(code) && next.brigOffset() > code.brigOffset() && hasher->hash(code, key);
+            bool cached = keyed && cache->contains(key);
+
+            if (!cached)
+            {
+                validateCodeItem(code, instValidator);
+
+                bodyStart = isSbr(code)? getFirstScoped(code).brigOffset() : 0;
+                bodyEnd   = isSbr(code)? next.brigOffset() : 0;
+                for (Code c = code.next(); c != next; c = c.next()) validateCodeItem(c, instValidator);
+            }
+
+            if (Directive d = code)
+            {
+                validate(d, isTopLevelStatement(d), "Directive is not allowed at top level");
+                validateOrder(d, context);
+
+                if (DirectiveModule(d))  context.defineModule(d);
+                else if (cached)         validateCachedSbr(d, context);
+                else if (isSbr(d))       validateSbr(d, context);
+                else                     validateDefUse(d, context);
+            }
+
+            if (keyed && !cached) validated.push_back(key);
+
+            code = next;
+        }
+
+        context.endModule();
+
+        for (size_t i = 0; i < validated.size(); ++i) cache->insert(validated[i]);
+    }
+
+    // Hashes of executables depend on the properties of the module
+    // which affect their validation
+    std::unique_ptr<ExecutableHasher> startHashing(const ValidationCache &c) const
+    {
+        std::unique_ptr<ExecutableHasher> hasher(new ExecutableHasher(c.seed()));
+        hasher->addModuleProperty(major);
+        hasher->addModuleProperty(minor);
+        hasher->addModuleProperty(mModel);
+        hasher->addModuleProperty(mProfile);
+
+        // extensions must follow the module directive, those found
+        // later make the module invalid anyway
+        Code code = brig.code().begin();
+        for (; code != brig.code().end() && (isAnnotation(code) || DirectiveModule(code)); code = code.next()) {}
+        for (; code != brig.code().end() && (isAnnotation(code) || DirectiveExtension(code)); code = code.next())
+        {
+            if (DirectiveExtension ext = code) hasher->addModuleProperty(SRef(ext.name()));
+        }
+        return hasher;
+    }
+
+    // An executable from the cache is known to be valid by itself, only its
+    // definition and uses of module scope symbols are checked in the module
+    void validateCachedSbr(DirectiveExecutable d, ValidatorContext &context) const
+    {
+        context.defineSbr(d);
+
+        Offset start = d.brigOffset();
+        Code   end   = getNextTopLevel(d);
+        for (Code p = getFirstScoped(d); p != end; p = p.next())
+        {
+            if (Inst i = p)
+            {
+                unsigned numOperands = getOperandsNum(i);
+                for (unsigned idx = 0; idx < numOperands; ++idx)
+                {
+                    validateModuleSymUse(i, i.operand(idx), start, end.brigOffset(), context);
+                }
+            }
+            else if (DirectivePragma pragma = p)
+            {
+                unsigned len = pragma.operands().size();
+                for (unsigned idx = 0; idx < len; ++idx)
+                {
+                    validateModuleSymUse(p, pragma.operands()[idx], start, end.brigOffset(), context);
+                }
+            }
+        }
+    }
 
-                validateComplexInst(inst);
+    // Check use of symbols outside of the range [start, end), which are
+    // module scope symbols in cached executables (see ExecutableHasher)
+    void validateModuleSymUse(Code owner, Operand opr, Offset start, Offset end, ValidatorContext &context) const
+    {
+        Code sym;
+        if      (OperandAddress addr = opr) sym = addr.symbol();
+        else if (OperandCodeRef ref = opr)  sym = ref.ref();
+        else if (OperandCodeList list = opr)
+        {
+            unsigned size = list.elements().size();
+            for (unsigned i = 0; i < size; ++i)
+            {
+                Code elem = list.elements()[i];
+                if (isOutside(elem, start, end) && (isFunc(elem) || isVar(elem))) validateSymUse(owner, list, elem, context);
             }
         }
+        if (sym && isOutside(sym, start, end)) validateSymUse(owner, opr, sym, context);
+    }
+
+    static bool isOutside(Code c, Offset start, Offset end) { return c.brigOffset() < start || end <= c.brigOffset(); }
+
+    void validateCodeItem(Code code, InstValidator &instValidator)
+    {
+        if (isDirective(code.kind())) validateDirective(code);
+        else                          validateInstItem(code, instValidator);
     }
 
     //-------------------------------------------------------------------------
@@ -1638,6 +2087,7 @@ private:
 
     void validateBrigDefs() const
     {
+        PROFILE_PHASE(PHASE_DEFS);
         ValidatorContext context(brig);
 
         // Find all definitions and declarations of module identifiers
@@ -1759,7 +2209,9 @@ private:
         if (isVar(d) || isFbar(d) || isSbr(d))
         {
             context.registerGlobalSym(d);
-            return getNextTopLevel(d);
+            Code next = getNextTopLevel(d);
+            validate(d, next.brigOffset() > d.brigOffset(), "Invalid reference to next toplevel directive");
+            return next;
         }
         return d.next();
     }
@@ -1858,12 +2310,13 @@ private:
         }
         else if (DirectiveModule(sym))
         {
-            assert(DirectivePragma(owner));
+            validate(owner, DirectivePragma(owner), "Invalid reference to module directive");
             // Nothing to validate here - see validation of pragma
         }
         else
         {
-            assert(false);
+            // rejected by instruction rules, may get here below VALIDATION_FULL
+            validate(opr, false, "Invalid symbol reference");
         }
     }
 
@@ -1915,8 +2368,9 @@ private:
             context.startCall(i);
 
             // validate that all arguments are defined in the current scope
-            if (i.operand(0)) validateCallArgScope(i, context, i.operand(0), true);  // output
-            if (i.operand(2)) validateCallArgScope(i, context, i.operand(2), false); // input
+            // NB: operand kinds are only known to be right at VALIDATION_FULL
+            if (OperandCodeList out = i.operand(0)) validateCallArgScope(i, context, out, true);  // output
+            if (OperandCodeList in  = i.operand(2)) validateCallArgScope(i, context, in,  false); // input
 
             context.endCall(i);
         }
@@ -2272,7 +2726,8 @@ private:
     void validateComplexInst(Inst i) const
     {
         // Validate that there is a kernel/function which uses this instruction
-        validate(i, usedInst.count(i.brigOffset()) > 0, "Instruction does not belong to any kernel/function");
+        bool used = fusedTraversal? bodyStart <= i.brigOffset() && i.brigOffset() < bodyEnd : usedInst.count(i.brigOffset()) > 0;
+        validate(i, used, "Instruction does not belong to any kernel/function");
 
         switch(i.opcode())
         {
@@ -2800,7 +3255,7 @@ private:
         unsigned idx = getScopedSize(sbr);
         for (it = getFirstScoped(sbr); it != end; it = it.next())
         {
-            if (isInstruction(it.kind()))
+            if (isInstruction(it.kind()) && !fusedTraversal)
             {
                 usedInst.insert(it.brigOffset()); // Mark as used
             }
@@ -2877,7 +3332,7 @@ private:
         if (offset == 0 && !z)                        invalidOffset(item, section, structName, fieldName, "cannot be 0");
         if (offset > size || (offset == size && !ex)) invalidOffset(item, section, structName, fieldName, "is out of section");
 
-        if (offset > 0 && offset < size && !std::binary_search(map[section].begin(), map[section].end(), offset))
+        if (offset > 0 && offset < size && !std::binary_search(itemOffsets[section]->begin(), itemOffsets[section]->end(), offset))
         {
             invalidOffset(item, section, structName, fieldName, "points at the middle of an item");
         }
@@ -3431,9 +3886,268 @@ Validator::Validator(BrigContainer &c) { impl = new ValidatorImpl(c); }
 Validator::~Validator()                { delete impl; }
 
 bool   Validator::validate(bool disasmOnError /*= false*/) const { return impl->validate(disasmOnError); }
+void   Validator::setFusedTraversal(bool fused)                 { impl->setFusedTraversal(fused); }
+void   Validator::setLevel(ValidationLevel level)               { impl->setLevel(level); }
+void   Validator::setCache(ValidationCache* cache)              { impl->setCache(cache); }
+const ValidationProfile& Validator::getProfile()           const { return impl->getProfile(); }
 string Validator::getErrorMsg(istream *is)                 const { return impl->getErrorMsg(is); }
+string Validator::getErrorMsg(const SourceLineIndex& lines) const { return impl->getErrorMsg(NULL, &lines); }
 int    Validator::getErrorCode()                           const { return impl->getErrorCode(); }
 
+// ============================================================================
+// Program validation
+
+struct ProgramModule
+{
+    BrigContainer     *brig;
+    string             name;
+    string             errorMsg;
+    int                errorCode;
+    vector<Directive>  symbols;     // declarations and definitions with program linkage
+};
+
+// Symbols with program linkage of all the modules by name and their
+// definitions. Open addressing with linear probing; the number of symbols
+// is known in advance, so the table never grows.
+class ProgramSymbolTable
+{
+public:
+    struct Entry
+    {
+        SRef      name;
+        uint32_t  hash;
+        Directive def;
+        unsigned  defModule;
+    };
+
+private:
+    vector<Entry>    m_entries;
+    vector<uint32_t> m_slots;       // index of the entry + 1, 0 is an empty slot
+
+public:
+    explicit ProgramSymbolTable(size_t maxSymbols)
+    {
+        size_t capacity = 16;
+        while (capacity < 2 * maxSymbols) capacity *= 2;
+        m_slots.assign(capacity, 0);
+        m_entries.reserve(maxSymbols);
+    }
+
+    Entry& get(SRef name)
+    {
+        uint32_t hash = symbolIndexHash(name);
+        size_t   mask = m_slots.size() - 1;
+        size_t   i    = hash & mask;
+        for (; m_slots[i] != 0; i = (i + 1) & mask)
+        {
+            Entry &e = m_entries[m_slots[i] - 1];
+            if (e.hash == hash && e.name == name) return e;
+        }
+
+        assert(m_entries.size() < m_entries.capacity());
+        Entry e = { name, hash, Directive(), 0 };
+        m_entries.push_back(e);
+        m_slots[i] = (uint32_t)m_entries.size();
+        return m_entries.back();
+    }
+};
+
+class ProgramValidatorImpl : public BrigHelper
+{
+private:
+    vector<ProgramModule> modules;
+    ValidationLevel level;
+    ValidationCache *cache;
+
+    vector<string> errors;
+    int errorCode;
+
+public:
+    ProgramValidatorImpl() : level(VALIDATION_FULL), cache(0), errorCode(0) {}
+
+    void addModule(BrigContainer &c, const string &name)
+    {
+        ProgramModule m;
+        m.brig      = &c;
+        m.name      = name;
+        m.errorCode = 0;
+        modules.push_back(m);
+    }
+
+    void setLevel(ValidationLevel l)   { level = l; }
+    void setCache(ValidationCache *c)  { cache = c; }
+
+    bool validate(unsigned numThreads)
+    {
+        errors.clear();
+        errorCode = 0;
+
+        if (level == VALIDATION_NONE) return true;
+
+        std::atomic<size_t> next(0);
+        auto worker = [&]() {
+            for (size_t i; (i = next++) < modules.size(); ) validateModule(modules[i]);
+        };
+        vector<std::thread> threads;
+        for (size_t i = 1; i < std::min<size_t>(numThreads, modules.size()); ++i)
+        {
+            threads.push_back(std::thread(worker));
+        }
+        worker();
+        for (size_t i = 0; i < threads.size(); ++i) threads[i].join();
+
+        for (size_t i = 0; i < modules.size(); ++i)
+        {
+            if (modules[i].errorCode == 0) continue;
+
+            errors.push_back(modules[i].name + ": " + modules[i].errorMsg);
+            if (errorCode == 0) errorCode = modules[i].errorCode;
+        }
+        if (!errors.empty()) return false;
+
+        validateLinkage();
+        return errors.empty();
+    }
+
+    string getErrorMsg() const
+    {
+        string res;
+        for (size_t i = 0; i < errors.size(); ++i) res += errors[i] + "\n";
+        return res;
+    }
+
+    int getErrorCode() const { return errorCode; }
+
+private:
+    void validateModule(ProgramModule &m) const
+    {
+        m.symbols.clear();
+
+        Validator v(*m.brig);
+        v.setLevel(level);
+        v.setCache(cache);
+        if (!v.validate())
+        {
+            m.errorMsg  = v.getErrorMsg(NULL);
+            m.errorCode = v.getErrorCode();
+            return;
+        }
+        m.errorMsg.clear();
+        m.errorCode = 0;
+
+        for (Code d = m.brig->code().begin(); d != m.brig->code().end(); d = getNextTopLevel(d))
+        {
+            if ((isVar(d) || isFbar(d) || (isSbr(d) && !isSignature(d))) && isProgLinkage(d)) m.symbols.push_back(d);
+        }
+    }
+
+    // Definitions are registered first, so that declarations of
+    // a symbol are checked against its definition wherever it is
+    void validateLinkage()
+    {
+        size_t numSymbols = 0;
+        for (size_t i = 0; i < modules.size(); ++i) numSymbols += modules[i].symbols.size();
+
+        ProgramSymbolTable table(numSymbols);
+
+        for (unsigned i = 0; i < modules.size(); ++i)
+        {
+            const vector<Directive> &symbols = modules[i].symbols;
+            for (size_t j = 0; j < symbols.size(); ++j)
+            {
+                if (!isDef(symbols[j])) continue;
+
+                ProgramSymbolTable::Entry &e = table.get(getName(symbols[j]));
+                if (e.def)
+                {
+                    linkError(i, symbols[j], "is already defined in " + modules[e.defModule].name);
+                }
+                else
+                {
+                    e.def       = symbols[j];
+                    e.defModule = i;
+                }
+            }
+        }
+
+        for (unsigned i = 0; i < modules.size(); ++i)
+        {
+            const vector<Directive> &symbols = modules[i].symbols;
+            for (size_t j = 0; j < symbols.size(); ++j)
+            {
+                Directive d = symbols[j];
+                if (isDef(d)) continue;
+
+                const ProgramSymbolTable::Entry &e = table.get(getName(d));
+                if (!e.def)
+                {
+                    linkError(i, d, "is declared with program linkage but is not defined in any module");
+                }
+                else if (d.kind() != e.def.kind() || !eqDecl(d, e.def))
+                {
+                    linkError(i, d, "is declared incompatibly with its definition in " + modules[e.defModule].name);
+                }
+            }
+        }
+    }
+
+    void linkError(unsigned module, Directive d, const string &msg)
+    {
+        errors.push_back(modules[module].name + ": " + string(getName(d)) + " " + msg);
+        errorCode = BrigFormatError::ERRCODE_LINK;
+    }
+};
+
+ProgramValidator::ProgramValidator()  { impl = new ProgramValidatorImpl(); }
+ProgramValidator::~ProgramValidator() { delete impl; }
+
+void   ProgramValidator::addModule(BrigContainer &c, const string& name) { impl->addModule(c, name); }
+void   ProgramValidator::setLevel(ValidationLevel level)                 { impl->setLevel(level); }
+void   ProgramValidator::setCache(ValidationCache* cache)                { impl->setCache(cache); }
+bool   ProgramValidator::validate(unsigned numThreads)             const { return impl->validate(numThreads); }
+string ProgramValidator::getErrorMsg()                             const { return impl->getErrorMsg(); }
+int    ProgramValidator::getErrorCode()                            const { return impl->getErrorCode(); }
+
+// ============================================================================
+// Recorded validation level
+
+static const BrigSectionImpl* findValidationLevelSection(const BrigContainer& c)
+{
+    for(int i = BRIG_SECTION_INDEX_IMPLEMENTATION_DEFINED; i < c.getNumSections(); ++i) {
+        const BrigSectionImpl& s = c.sectionById(i);
+        const BrigSectionHeader* h = s.secHeader();
+        if (SRef((const char*)h->name, (const char*)h->name + h->nameLength) == VALIDATION_LEVEL_SECTION_NAME) return &s;
+    }
+    return NULL;
+}
+
+void recordValidationLevel(BrigContainer& c, ValidationLevel level)
+{
+    uint32_t const payload = level;
+
+    BrigSectionImpl* sec = const_cast<BrigSectionImpl*>(findValidationLevelSection(c));
+    if (sec) {
+        sec->clear();
+    } else {
+        std::unique_ptr<BrigSectionImpl> s(new BrigSectionRaw(SRef(VALIDATION_LEVEL_SECTION_NAME)));
+        sec = s.get();
+        c.addSection(std::move(s));
+    }
+    sec->insertData(sec->size(), (const char*)&payload, (const char*)(&payload + 1));
+}
+
+ValidationLevel getRecordedValidationLevel(const BrigContainer& c)
+{
+    const BrigSectionImpl* sec = findValidationLevelSection(c);
+    if (!sec) return VALIDATION_NONE;
+
+    uint64_t const hdrSize = sec->secHeader()->headerByteCount;
+    if ((hdrSize & 0x3) != 0 || sec->size() != hdrSize + sizeof(uint32_t)) return VALIDATION_NONE;
+
+    uint32_t const level = *sec->getData<uint32_t>((Offset)hdrSize);
+    return level <= VALIDATION_FULL? (ValidationLevel)level : VALIDATION_NONE;
+}
+
 // ============================================================================
 } // HSAIL_ASM namespace
 
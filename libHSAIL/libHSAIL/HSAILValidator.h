@@ -47,15 +47,59 @@
 #include "HSAILItemBase.h"
 #include "HSAILItems.h"
 #include <istream>
+#include <ostream>
 #include <string>
+#include <vector>
+#include <stdint.h>
 
 using std::istream;
 
+class SourceLineIndex;
+
 namespace HSAIL_ASM {
 
 //============================================================================
 
 class ValidatorImpl;
+class ProgramValidatorImpl;
+class ValidationCache;
+
+/// amount of checks done by Validator::validate, each level includes
+/// the checks of the previous ones
+enum ValidationLevel {
+    VALIDATION_NONE      = 0, // nothing is checked (only meaningful as a recorded level)
+    VALIDATION_STRUCTURE = 1, // sections, item kinds and sizes, field values and offsets
+                              // in range: enough to walk the BRIG without memory errors
+    VALIDATION_DEF_USE   = 2, // directive and operand rules, symbol definitions and uses
+    VALIDATION_FULL      = 3  // instruction rules (the default)
+};
+
+/// name of the implementation defined section which records the level
+/// the module has been validated at by its producer. The payload is a
+/// single 32-bit ValidationLevel.
+#define VALIDATION_LEVEL_SECTION_NAME "hsa_validation"
+
+/// time spent in the validation phases and in the instruction rules of each
+/// opcode by the last Validator::validate. Only collected when libHSAIL is
+/// built with HSAIL_VALIDATOR_PROFILE, empty otherwise. The time of a phase
+/// includes the time of instruction rules checked by it.
+struct ValidationProfile
+{
+    struct Entry
+    {
+        std::string name;   // phase, or "InstValidator::" and the opcode
+        uint64_t    calls;
+        double      seconds;
+    };
+
+    std::vector<Entry> entries; // longest first, the first one is the whole validation
+
+    /// whether libHSAIL has been built with profiling support
+    static bool isEnabled();
+
+    void printTable(std::ostream& os) const;
+    void printJson(std::ostream& os) const;
+};
 
 class Validator
 {
@@ -72,10 +116,80 @@ public:
 
     bool validate(bool disasmOnError = false) const;
 
+    /// walk each section once performing all the checks of an item
+    /// together (the default), or run the checks one kind at a time
+    /// over the whole module.
+    void setFusedTraversal(bool fused);
+
+    /// checks done by validate(), VALIDATION_FULL by default. A module
+    /// produced by a trusted tool may be validated at a lower level.
+    void setLevel(ValidationLevel level);
+
+    /// skip checks of kernels and functions found in the cache, only checking
+    /// their definitions and uses of module scope symbols against the module.
+    /// Executables of a module which passes validation are added to the cache.
+    /// Only used by the fused traversal at VALIDATION_FULL. The cache is not
+    /// owned by the validator.
+    void setCache(ValidationCache* cache);
+
+    /// time spent in the last validate(), see ValidationProfile
+    const ValidationProfile& getProfile() const;
+
     std::string getErrorMsg(istream *is) const;
+    std::string getErrorMsg(const SourceLineIndex& lines) const;
     int getErrorCode() const;
 };
 
+/// Validates a program made of several modules without merging them: each
+/// module is validated by a Validator, concurrently on several threads, then
+/// symbols with program linkage are resolved across the modules. Each such
+/// symbol may be defined in only one module, and each declaration must have
+/// a definition which is compatible with it (as declarations of a symbol
+/// within a module must be). Linkage is only checked when all the modules
+/// are valid.
+class ProgramValidator
+{
+    ProgramValidatorImpl *impl;
+
+    ProgramValidator(const ProgramValidator&); // non-copyable
+    const ProgramValidator &operator=(const ProgramValidator &); // not assignable
+
+public:
+    ProgramValidator();
+    ~ProgramValidator();
+
+    /// the container is not owned and must not be changed until validation
+    /// is complete. The name identifies the module in error messages.
+    void addModule(BrigContainer &c, const std::string& name);
+
+    /// checks done by the validator of each module, VALIDATION_FULL by
+    /// default. Linkage is checked at all levels but VALIDATION_NONE.
+    void setLevel(ValidationLevel level);
+
+    /// see Validator::setCache
+    void setCache(ValidationCache* cache);
+
+    /// validates the modules on up to numThreads threads. Returns false if
+    /// any of the modules is invalid or there is a linkage error.
+    bool validate(unsigned numThreads = 1) const;
+
+    /// the first error of each invalid module, or all linkage errors,
+    /// one per line, prefixed with names of the modules.
+    std::string getErrorMsg() const;
+
+    /// error code of the first invalid module, or the linkage error code
+    int getErrorCode() const;
+};
+
+/// stores the level in the validation level section of the container,
+/// replacing the previous one. The container must be writeable.
+void recordValidationLevel(BrigContainer& c, ValidationLevel level);
+
+/// returns the level recorded in the container, or VALIDATION_NONE if there
+/// is no such record or it is malformed. The record is a claim of the producer
+/// of the module, it is up to the consumer whether to trust it.
+ValidationLevel getRecordedValidationLevel(const BrigContainer& c);
+
 } // namespace HSAIL_ASM
 
 #endif
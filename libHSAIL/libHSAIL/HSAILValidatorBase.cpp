@@ -631,6 +631,24 @@ bool PropValidator::checkOperandKind(Inst inst, unsigned operandIdx, unsigned* v
     return false;
 }
 
+// Returns a subset of OPERAND_VAL_* values accepted by checkOperandKind for this operand.
+// Only kinds which are identified by the kind of operand alone are reported;
+// other operands (e.g. immediates and vectors) are checked by checkOperandKind.
+uint64_t PropValidator::getOperandKinds(Operand opr)
+{
+    static_assert(OPERAND_VAL_INVALID < 64, "operand kinds must fit into a single word of BrigValueSet");
+
+    if (!opr) return uint64_t(1) << OPERAND_VAL_NULL;
+
+    switch (opr.kind())
+    {
+    case BRIG_KIND_OPERAND_REGISTER: return uint64_t(1) << OPERAND_VAL_REG;
+    case BRIG_KIND_OPERAND_ADDRESS:  return uint64_t(1) << OPERAND_VAL_ADDR;
+    case BRIG_KIND_OPERAND_WAVESIZE: return uint64_t(1) << OPERAND_VAL_IMM;
+    default:                         return 0;
+    }
+}
+
 bool PropValidator::validateOperand(Inst inst, unsigned prop, unsigned attr, unsigned* vals, unsigned length, bool isAssert /*=true*/)
 {
     assert(inst);
@@ -638,7 +656,6 @@ bool PropValidator::validateOperand(Inst inst, unsigned prop, unsigned attr, uns
     assert(PROP_MINID < prop && prop < PROP_MAXID);
     assert(ATTR_MINID < attr && attr < ATTR_MAXID);
 
-    bool isDst = (prop == PROP_D0 || prop == PROP_D1);
     unsigned oprIdx = getOperandIdx(prop);
     assert(oprIdx <= 4);
 
@@ -648,6 +665,32 @@ bool PropValidator::validateOperand(Inst inst, unsigned prop, unsigned attr, uns
         return false;
     }
 
+    return validateOperandProps(inst, prop, attr, isAssert);
+}
+
+// Same as above, but common kinds of operands are checked with a single lookup
+// in a table generated from 'vals'. Other operands are checked using the list.
+bool PropValidator::validateOperand(Inst inst, unsigned prop, unsigned attr, const BrigValueSet& kinds, unsigned* vals, unsigned length, bool isAssert /*=true*/)
+{
+    assert(inst);
+    assert(PROP_MINID < prop && prop < PROP_MAXID);
+
+    Operand opr = inst.operand(getOperandIdx(prop));
+    if ((getOperandKinds(opr) & kinds.bits[0]) == 0)
+    {
+        return validateOperand(inst, prop, attr, vals, length, isAssert);
+    }
+
+    if (!opr && attr == OPERAND_ATTR_NONE) return true;
+    return validateOperandProps(inst, prop, attr, isAssert);
+}
+
+bool PropValidator::validateOperandProps(Inst inst, unsigned prop, unsigned attr, bool isAssert)
+{
+    bool isDst = (prop == PROP_D0 || prop == PROP_D1);
+    unsigned oprIdx = getOperandIdx(prop);
+    assert(oprIdx <= 4);
+
     OperandOperandList vec = inst.operand(oprIdx);
     if (isDst && vec && !validateDstVector(inst, vec, oprIdx, isAssert)) return false;
 
@@ -964,6 +1007,17 @@ bool PropValidator::validateOperandType(Inst inst, unsigned oprIdx, bool isDst,
         return false;
     }
 
+    uint64_t key = OperandCheckCache::key(opr.brigOffset(), type, isDst);
+    if (mOperandChecks.contains(key)) return true;
+
+    if (!validateOperandType(inst, opr, oprIdx, isDst, type, attr, isAssert)) return false;
+
+    mOperandChecks.insert(key);
+    return true;
+}
+
+bool PropValidator::validateOperandType(Inst inst, Operand opr, unsigned oprIdx, bool isDst, unsigned type, unsigned attr, bool isAssert)
+{
     if (isDst && !OperandRegister(opr) && !OperandOperandList(opr))
     {
         if (isAssert) operandError(inst, oprIdx, "must be a register or a vector");
@@ -1050,6 +1104,50 @@ bool PropValidator::validateInstTypeSize(Inst inst, unsigned type, const char* t
     return true;
 }
 
+//============================================================================
+// OperandCheckCache
+
+void OperandCheckCache::enable(size_t capacity)
+{
+    assert(capacity > 0 && (capacity & (capacity - 1)) == 0);
+
+    m_keys.assign(capacity, 0);
+    m_size = m_lookups = m_hits = 0;
+}
+
+void OperandCheckCache::insert(uint64_t key)
+{
+    assert(key != 0);
+    if (m_keys.empty()) return;
+
+    if (m_lookups >= PROBATION && m_hits * 8 < m_lookups) // operands are not shared
+    {
+        std::vector<uint64_t>().swap(m_keys);
+        m_size = 0;
+        return;
+    }
+
+    if (2 * (m_size + 1) > m_keys.size()) // keep load factor below 1/2
+    {
+        std::vector<uint64_t> keys(2 * m_keys.size(), 0);
+        keys.swap(m_keys);
+        m_size = 0;
+        for (size_t i = 0; i < keys.size(); ++i)
+        {
+            if (keys[i] != 0) insert(keys[i]);
+        }
+    }
+
+    size_t mask = m_keys.size() - 1;
+    size_t i = slot(key, mask);
+    for (; m_keys[i] != 0; i = (i + 1) & mask)
+    {
+        if (m_keys[i] == key) return;
+    }
+    m_keys[i] = key;
+    ++m_size;
+}
+
 //-----------------------------------------------------------------------------
 
 } // namespace HSAIL_ASM
@@ -52,6 +52,7 @@
 #include "HSAILInstProps.h"
 
 #include <string.h>
+#include <vector>
 
 using std::string;
 
@@ -64,6 +65,83 @@ using namespace HSAIL_PROPS;
 
 namespace HSAIL_ASM {
 
+//============================================================================
+// Set of values of a BRIG property. HDL-generated code builds these at
+// compile time from the lists of allowed values so that checking a property
+// is a single bit test; the lists themselves are only used for error messages.
+
+struct BrigValueSet
+{
+    enum { MAX_VALUES = 256 };
+
+    uint64_t bits[MAX_VALUES / 64];
+
+    bool contains(unsigned val) const { return val < MAX_VALUES && ((bits[val >> 6] >> (val & 63)) & 1) != 0; }
+};
+
+constexpr uint64_t brigValueSetWord(unsigned) { return 0; }
+
+template<class... Vals> constexpr uint64_t brigValueSetWord(unsigned word, unsigned val, Vals... vals)
+{
+    return (val < BrigValueSet::MAX_VALUES? ((val >> 6) == word? uint64_t(1) << (val & 63) : 0) :
+                                            throw "BRIG property value does not fit into BrigValueSet") |
+           brigValueSetWord(word, vals...);
+}
+
+template<class... Vals> constexpr BrigValueSet makeBrigValueSet(Vals... vals)
+{
+    return BrigValueSet{{ brigValueSetWord(0, vals...), brigValueSetWord(1, vals...),
+                          brigValueSetWord(2, vals...), brigValueSetWord(3, vals...) }};
+}
+
+//============================================================================
+// Operand checks which have succeeded during a validation run. The result of
+// checking an operand against an expected type does not depend on the
+// instruction, so when producers share operands between instructions each
+// (operand, type) pair is only checked once. Open addressing with linear
+// probing; the table is empty (and the cache disabled) until enable() is
+// called. BRIG produced by the assembler does not share operands, so the
+// cache disables itself if it hardly ever hits during the first lookups.
+
+class OperandCheckCache
+{
+private:
+    static const size_t PROBATION = 256; // lookups before the hit rate is checked
+
+    std::vector<uint64_t> m_keys; // 0 is an empty slot
+    size_t m_size;
+    size_t m_lookups;
+    size_t m_hits;
+
+public:
+    OperandCheckCache() : m_size(0), m_lookups(0), m_hits(0) {}
+
+    static uint64_t key(Offset opr, unsigned type, bool isDst)
+    {
+        assert(opr != 0 && type <= 0xFFFF);
+        return (uint64_t(opr) << 17) | (type << 1) | (isDst? 1 : 0);
+    }
+
+    void enable(size_t capacity = 1024);
+
+    bool contains(uint64_t key)
+    {
+        if (m_keys.empty()) return false;
+        ++m_lookups;
+        size_t mask = m_keys.size() - 1;
+        for (size_t i = slot(key, mask); m_keys[i] != 0; i = (i + 1) & mask)
+        {
+            if (m_keys[i] == key) { ++m_hits; return true; }
+        }
+        return false;
+    }
+
+    void insert(uint64_t key);
+
+private:
+    static size_t slot(uint64_t key, size_t mask) { return (size_t)((key * 0x9E3779B97F4A7C15ULL) >> 32) & mask; }
+};
+
 //============================================================================
 
 class PropValidator
@@ -71,6 +149,7 @@ class PropValidator
 private:
     const unsigned mModel;
     const unsigned mProfile;
+    OperandCheckCache mOperandChecks;
 
     //==========================================================================
 public:
@@ -80,6 +159,9 @@ public:
     bool isLargeModel()        { return mModel   == BRIG_MACHINE_LARGE; }
     bool isFullProfile()       { return mProfile == BRIG_PROFILE_FULL; }
 
+    // Remember successful operand checks until this validator is destroyed
+    void enableOperandCheckCache() { mOperandChecks.enable(); }
+
     //==========================================================================
     // Interface with HDL-generated code
 protected:
@@ -93,6 +175,7 @@ protected:
     void invalidFormat(Inst inst, const char* msg);
 
     bool validateOperand(Inst inst, unsigned prop, unsigned attr, unsigned* vals, unsigned length, bool isAssert = true);
+    bool validateOperand(Inst inst, unsigned prop, unsigned attr, const BrigValueSet& kinds, unsigned* vals, unsigned length, bool isAssert = true);
     bool validateTypeSz(Inst inst, unsigned propVal, unsigned type, const char* typeName, bool isAssert = true);
     bool validateTypesize(Inst inst, unsigned prop, unsigned attr, unsigned* vals, unsigned length, bool isAssert = true);
     bool validateStypesize(Inst inst, unsigned prop, unsigned attr, unsigned* vals, unsigned length, bool isAssert = true);
@@ -149,6 +232,7 @@ public:
 private:
     bool validateOperandAttr(Inst inst, unsigned idx, unsigned attr, bool isDst, bool isAssert);
     bool checkOperandKind(Inst inst, unsigned idx, unsigned* vals, unsigned length, bool isAssert);
+    bool validateOperandProps(Inst inst, unsigned prop, unsigned attr, bool isAssert);
     bool checkAddrSeg(Inst inst, unsigned operandIdx, bool isAssert);
     bool checkAddrTSeg(Inst inst, unsigned operandIdx, bool isAssert);
 
@@ -158,6 +242,7 @@ private:
     static bool isJumpTab(Operand opr);
     static bool isImm(Operand opr);
     static bool isImmInRange(Operand opr, unsigned low, unsigned high);
+    static uint64_t getOperandKinds(Operand opr);
     static bool eqTypes(unsigned type1, unsigned type2) { return getBrigTypeNumBits(type1) == getBrigTypeNumBits(type2); }
     void propError(Inst inst, unsigned prop, string value, unsigned* vals, unsigned length);
 
@@ -165,6 +250,7 @@ private:
 private:
     bool validateDstVector(Inst inst, OperandOperandList vector, unsigned oprIdx, bool isAssert);
     bool validateOperandType(Inst inst, unsigned oprIdx, bool isDst, unsigned attr, bool isAssert);
+    bool validateOperandType(Inst inst, Operand opr, unsigned oprIdx, bool isDst, unsigned type, unsigned attr, bool isAssert);
     bool validateOperandReg(Inst inst, OperandRegister opr, unsigned oprIdx, unsigned type, unsigned attr, bool isAssert);
     bool validateOperandImmed(Inst inst, OperandConstantBytes opr, unsigned oprIdx, unsigned type, unsigned attr, bool isAssert);
     bool validateOperandWavesize(Inst inst, unsigned oprIdx, unsigned type, unsigned attr, bool isAssert);
@@ -41,12 +41,16 @@
 #include "hsail_c.h"
 #include <fstream>
 #include <sstream>
+#include <cstddef>
 #include <cstdlib>
+#include <memory>
 #include "HSAILBrigContainer.h"
+#include "HSAILBrigBuilder.h"
 #include "HSAILBrigObjectFile.h"
 #include "HSAILParser.h"
 #include "HSAILDisassembler.h"
 #include "HSAILValidator.h"
+#include "HSAILSymbolIndex.h"
 #ifdef _WIN32
 extern "C" {
     int __setargv(void);
@@ -67,6 +71,10 @@ namespace {
 struct Api {
     BrigContainer   container;
     std::string     errorText;
+    ValidationProfile validationProfile; // of the most recent validation
+    std::string     profileText;
+    std::unique_ptr<Brigantine>  brigantine; // while a program is built by brig_container_build_*
+    std::unique_ptr<BrigBuilder> builder;
 
     Api()
     : container()
@@ -81,9 +89,45 @@ struct Api {
     }
 };
 
+// brig_inst_desc and brig_operand_desc are passed to BrigBuilder as is
+static_assert(sizeof(brig_operand_desc)==sizeof(BrigOperandDesc) &&
+              offsetof(brig_operand_desc, num_elements)==offsetof(BrigOperandDesc, numElements),
+              "brig_operand_desc doesn't match BrigOperandDesc");
+static_assert(sizeof(brig_inst_desc)==sizeof(BrigInstDesc) &&
+              offsetof(brig_inst_desc, query)==offsetof(BrigInstDesc, query) &&
+              offsetof(brig_inst_desc, num_operands)==offsetof(BrigInstDesc, numOperands),
+              "brig_inst_desc doesn't match BrigInstDesc");
+
+static_assert((int)BRIG_VALIDATION_NONE==(int)VALIDATION_NONE && (int)BRIG_VALIDATION_STRUCTURE==(int)VALIDATION_STRUCTURE &&
+              (int)BRIG_VALIDATION_DEF_USE==(int)VALIDATION_DEF_USE && (int)BRIG_VALIDATION_FULL==(int)VALIDATION_FULL,
+              "brig_validation_level doesn't match ValidationLevel");
+
+static Api* startedBuild(brig_container_t handle)
+{
+    Api* const api = (Api*)handle;
+    if (!api->builder) {
+        api->errorText = "brig_container_build_start has not been called";
+        return NULL;
+    }
+    return api;
+}
+
+static int buildError(Api* api, const SyntaxError& e)
+{
+    api->errorText = e.what();
+    return 1;
+}
+
+static int buildOrderError(Api* api, const char* msg)
+{
+    api->errorText = msg;
+    return 1;
+}
+
 static int assemble(brig_container_t handle, std::istream& is, const char *options, const char *sourceDir = 0, const char *sourceFileName = 0)
 {
-    bool DisableValidator = false, IncludeSource = false;
+    bool DisableValidator = false, IncludeSource = false, RecordValidationLevel = false;
+    ValidationLevel level = VALIDATION_FULL;
 #ifdef WITH_LIBBRIGDWARF
     bool EnableDebugInfo = false;
 #endif // WITH_LIBBRIGDWARF
@@ -99,6 +143,10 @@ static int assemble(brig_container_t handle, std::istream& is, const char *optio
     while (iss >> opt) {
                if (opt == "-include-source") { IncludeSource = true; }
           else if (opt == "-disable-validator") { DisableValidator = true; }
+          else if (opt == "-validation-level=structure") { level = VALIDATION_STRUCTURE; }
+          else if (opt == "-validation-level=defuse") { level = VALIDATION_DEF_USE; }
+          else if (opt == "-validation-level=full") { level = VALIDATION_FULL; }
+          else if (opt == "-record-validation-level") { RecordValidationLevel = true; }
 #ifdef WITH_LIBBRIGDWARF
           else if (opt == "-g") { EnableDebugInfo = true; }
 #endif // WITH_LIBBRIGDWARF
@@ -109,22 +157,25 @@ static int assemble(brig_container_t handle, std::istream& is, const char *optio
     }
 
     BrigContainer& c = ((Api*)handle)->container;
+    Scanner s(is, true);
     try {
-        Scanner s(is, true);
         Parser p(s, c);
         p.parseSource(IncludeSource);
     }
     catch(const SyntaxError& e) {
         std::stringstream ss;
-        e.print(ss, is);
+        e.print(ss, s.lineIndex());
         ((Api*)handle)->errorText = ss.str();
         return 1;
     }
     if (!DisableValidator) {
         Validator v(c);
-        if (!v.validate(true)) {
+        v.setLevel(level);
+        bool const valid = v.validate(true);
+        ((Api*)handle)->validationProfile = v.getProfile();
+        if (!valid) {
             std::stringstream ss;
-            ss << v.getErrorMsg(&is) << "\n";
+            ss << v.getErrorMsg(s.lineIndex()) << "\n";
             int rc = v.getErrorCode();
             ((Api*)handle)->errorText = ss.str();
             return rc;
@@ -145,6 +196,9 @@ static int assemble(brig_container_t handle, std::istream& is, const char *optio
         pBdig->storeInBrig(c);
     }
 #endif
+    if (RecordValidationLevel) {
+        recordValidationLevel(c, DisableValidator ? VALIDATION_NONE : level);
+    }
     return 0;
 }
 
@@ -260,9 +314,21 @@ HSAIL_C_API int brig_container_save_to_file(brig_container_t handle, const char*
 
 HSAIL_C_API int brig_container_validate(brig_container_t handle)
 {
+    return brig_container_validate_level(handle, BRIG_VALIDATION_FULL);
+}
+
+HSAIL_C_API int brig_container_validate_level(brig_container_t handle, unsigned level)
+{
+    if (level < BRIG_VALIDATION_STRUCTURE || level > BRIG_VALIDATION_FULL) {
+        ((Api*)handle)->errorText = "Invalid validation level";
+        return 1;
+    }
     std::stringstream ss;
     Validator v(((Api*)handle)->container);
-    if (!v.validate(true)) {
+    v.setLevel((ValidationLevel)level);
+    bool const valid = v.validate(true);
+    ((Api*)handle)->validationProfile = v.getProfile();
+    if (!valid) {
         ss << v.getErrorMsg(0) << "\n";
         int rc = v.getErrorCode();
         ((Api*)handle)->errorText = ss.str();
@@ -271,21 +337,184 @@ HSAIL_C_API int brig_container_validate(brig_container_t handle)
     return 0;
 }
 
+HSAIL_C_API unsigned brig_container_get_recorded_validation_level(brig_container_t handle)
+{
+    return getRecordedValidationLevel(((Api*)handle)->container);
+}
+
+HSAIL_C_API const char* brig_container_get_validation_profile(brig_container_t handle, unsigned format)
+{
+    Api* const api = (Api*)handle;
+    std::stringstream ss;
+    if (!api->validationProfile.entries.empty()) {
+        if (format == BRIG_VALIDATION_PROFILE_JSON) {
+            api->validationProfile.printJson(ss);
+        } else {
+            api->validationProfile.printTable(ss);
+        }
+    }
+    api->profileText = ss.str();
+    return api->profileText.c_str();
+}
+
 HSAIL_C_API brig_code_section_offset brig_container_find_code_module_symbol_offset(brig_container_t handle, const char *symbol_name)
 {
-  BrigContainer& c = ((Api*)handle)->container;
-  for (Code d = c.code().begin(), e = c.code().end(); d != e; ) {
-    if (DirectiveExecutable e = d) {
-      if (e.name().str() == symbol_name) { return e.brigOffset(); }
-      d = e.nextModuleEntry(); // Skip to next top level directive.
-    } else if (DirectiveVariable v = d) {
-      if (v.name().str() == symbol_name) { return v.brigOffset(); }
-      d = d.next(); // Skip to next directive.
-    } else {
-      d = d.next(); // Skip to next directive.
+  return findModuleSymbol(((Api*)handle)->container, SRef(symbol_name));
+}
+
+HSAIL_C_API int brig_container_build_start(brig_container_t handle)
+{
+    Api* const api = (Api*)handle;
+    if (api->builder) {
+        api->errorText = "a program is being built already";
+        return 1;
+    }
+    api->brigantine.reset(new Brigantine(api->container));
+    api->builder.reset(new BrigBuilder(*api->brigantine));
+    api->brigantine->startProgram();
+    return 0;
+}
+
+HSAIL_C_API int brig_container_build_module(brig_container_t handle, const char* name, unsigned major, unsigned minor,
+                                            unsigned machine_model, unsigned profile, unsigned default_rounding)
+{
+    Api* const api = startedBuild(handle);
+    if (!api) return 1;
+    try {
+        api->brigantine->module(SRef(name), major, minor, machine_model, profile, default_rounding);
+    } catch(const SyntaxError& e) {
+        return buildError(api, e);
+    }
+    return 0;
+}
+
+HSAIL_C_API int brig_container_build_executable(brig_container_t handle, unsigned kind, const char* name, unsigned linkage)
+{
+    Api* const api = startedBuild(handle);
+    if (!api) return 1;
+    if (api->brigantine->isInBody()) return buildOrderError(api, "a body has not been ended");
+    try {
+        DirectiveExecutable exe;
+        switch(kind) {
+        case BRIG_KIND_DIRECTIVE_KERNEL:            exe = api->brigantine->declKernel(SRef(name)); break;
+        case BRIG_KIND_DIRECTIVE_FUNCTION:          exe = api->brigantine->declFunc(SRef(name)); break;
+        case BRIG_KIND_DIRECTIVE_INDIRECT_FUNCTION: exe = api->brigantine->declIndirectFunc(SRef(name)); break;
+        case BRIG_KIND_DIRECTIVE_SIGNATURE:
+            exe = api->brigantine->declSignature(SRef(name));
+            exe.modifier().isDefinition() = true;
+            break;
+        default:
+            api->errorText = "invalid executable kind";
+            return 1;
+        }
+        exe.linkage() = linkage;
+    } catch(const SyntaxError& e) {
+        return buildError(api, e);
+    }
+    return 0;
+}
+
+HSAIL_C_API int brig_container_build_variable(brig_container_t handle, const char* name, unsigned segment, unsigned type,
+                                              uint64_t dim, unsigned role)
+{
+    Api* const api = startedBuild(handle);
+    if (!api) return 1;
+    try {
+        Brigantine& bw = *api->brigantine;
+        DirectiveVariable const var = dim > 0 ? bw.addArrayVariable(SRef(name), dim, segment, type)
+                                              : bw.addVariable(SRef(name), segment, type);
+        switch(role) {
+        case BRIG_VARIABLE_PLAIN: break;
+        case BRIG_VARIABLE_INPUT_PARAMETER:  bw.addInputParameter(var); break;
+        case BRIG_VARIABLE_OUTPUT_PARAMETER: bw.addOutputParameter(var); break;
+        default:
+            api->errorText = "invalid variable role";
+            return 1;
+        }
+    } catch(const SyntaxError& e) {
+        return buildError(api, e);
+    }
+    return 0;
+}
+
+HSAIL_C_API int brig_container_build_start_body(brig_container_t handle)
+{
+    Api* const api = startedBuild(handle);
+    if (!api) return 1;
+    if (!api->brigantine->currentExecutable()) return buildOrderError(api, "no executable has been declared");
+    if (api->brigantine->isInBody())           return buildOrderError(api, "a body has been started already");
+    try {
+        api->brigantine->startBody();
+    } catch(const SyntaxError& e) {
+        return buildError(api, e);
+    }
+    return 0;
+}
+
+HSAIL_C_API int brig_container_build_end_body(brig_container_t handle)
+{
+    Api* const api = startedBuild(handle);
+    if (!api) return 1;
+    if (!api->brigantine->isInBody())    return buildOrderError(api, "no body has been started");
+    if (api->brigantine->isInArgScope()) return buildOrderError(api, "an argument scope has not been ended");
+    try {
+        api->brigantine->endBody();
+    } catch(const SyntaxError& e) {
+        return buildError(api, e);
+    }
+    return 0;
+}
+
+HSAIL_C_API int brig_container_build_start_arg_scope(brig_container_t handle)
+{
+    Api* const api = startedBuild(handle);
+    if (!api) return 1;
+    if (!api->brigantine->isInBody())    return buildOrderError(api, "argument scopes are only allowed in a body");
+    if (api->brigantine->isInArgScope()) return buildOrderError(api, "nested argument scope is not allowed");
+    try {
+        api->brigantine->startArgScope();
+    } catch(const SyntaxError& e) {
+        return buildError(api, e);
+    }
+    return 0;
+}
+
+HSAIL_C_API int brig_container_build_end_arg_scope(brig_container_t handle)
+{
+    Api* const api = startedBuild(handle);
+    if (!api) return 1;
+    if (!api->brigantine->isInArgScope()) return buildOrderError(api, "no argument scope has been started");
+    try {
+        api->brigantine->endArgScope();
+    } catch(const SyntaxError& e) {
+        return buildError(api, e);
+    }
+    return 0;
+}
+
+HSAIL_C_API int brig_container_build_insts(brig_container_t handle, const brig_inst_desc* insts, size_t num_insts)
+{
+    Api* const api = startedBuild(handle);
+    if (!api) return 1;
+    if (!api->brigantine->isInBody()) return buildOrderError(api, "no body has been started");
+    try {
+        api->builder->addInsts(reinterpret_cast<const BrigInstDesc*>(insts), num_insts);
+    } catch(const SyntaxError& e) {
+        return buildError(api, e);
     }
-  }
-  return 0;
+    return 0;
+}
+
+HSAIL_C_API int brig_container_build_end(brig_container_t handle)
+{
+    Api* const api = startedBuild(handle);
+    if (!api) return 1;
+    if (api->brigantine->isInArgScope()) return buildOrderError(api, "an argument scope has not been ended");
+    if (api->brigantine->isInBody())     return buildOrderError(api, "a body has not been ended");
+    api->brigantine->endProgram();
+    api->builder.reset();
+    api->brigantine.reset();
+    return 0;
 }
 
 HSAIL_C_API const char* brig_container_get_error_text(brig_container_t handle) {
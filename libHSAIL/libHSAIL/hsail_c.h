@@ -216,6 +216,64 @@ HSAIL_C_API int         brig_container_save_to_file(brig_container_t handle, con
  */
 HSAIL_C_API int         brig_container_validate(brig_container_t handle);
 
+/**
+ * Checks done by brig_container_validate_level(), each level includes the previous ones.
+ */
+enum brig_validation_level {
+    BRIG_VALIDATION_NONE = 0,       /* nothing is checked (only meaningful as a recorded level) */
+    BRIG_VALIDATION_STRUCTURE,      /* sections, item sizes and offsets in range: enough for memory safety */
+    BRIG_VALIDATION_DEF_USE,        /* directives, operands, symbol definitions and uses */
+    BRIG_VALIDATION_FULL            /* all the rules, same as brig_container_validate() */
+};
+
+/**
+ * Validate a program in a BRIG container performing only the checks of the specified level.
+ *
+ * Programs produced by a trusted tool may be validated at a lower level,
+ * see brig_container_get_recorded_validation_level().
+ *
+ * @param handle - BRIG container handle.
+ * @param level - brig_validation_level value, BRIG_VALIDATION_NONE is rejected.
+ *
+ * @return zero if the program is valid, or a non-zero error code otherwise. Use brig_container_get_error_text() to receive further info on invalid BRIG.
+ */
+HSAIL_C_API int         brig_container_validate_level(brig_container_t handle, unsigned level);
+
+/**
+ * Get the validation level recorded by the producer of the program.
+ *
+ * The level is recorded in an implementation defined section by the assembler
+ * when the -record-validation-level option is given. The record is not checked,
+ * it is up to the caller whether to trust it.
+ *
+ * @param handle - BRIG container handle.
+ *
+ * @return brig_validation_level value, BRIG_VALIDATION_NONE if the level is not recorded.
+ */
+HSAIL_C_API unsigned    brig_container_get_recorded_validation_level(brig_container_t handle);
+
+/**
+ * Formats of brig_container_get_validation_profile().
+ */
+enum brig_validation_profile_format {
+    BRIG_VALIDATION_PROFILE_TABLE = 0,  /* text table */
+    BRIG_VALIDATION_PROFILE_JSON        /* JSON array of objects with name, calls and seconds */
+};
+
+/**
+ * Get time spent in the validation phases and in the instruction rules of each opcode
+ * by the most recent validation of the container (by brig_container_validate,
+ * brig_container_validate_level or while assembling), longest first.
+ *
+ * The profile is only collected when libHSAIL is built with HSAIL_VALIDATOR_PROFILE.
+ *
+ * @param handle - BRIG container handle.
+ * @param format - brig_validation_profile_format value.
+ *
+ * @return - profile text, empty if there is no profile. The text is valid until the next call of this function.
+ */
+HSAIL_C_API const char* brig_container_get_validation_profile(brig_container_t handle, unsigned format);
+
 /**
  * Obtain a pointer to BrigModule corresponding to this container (as void*)
  *
@@ -229,10 +287,183 @@ HSAIL_C_API int         brig_container_validate(brig_container_t handle);
 HSAIL_C_API void* brig_container_get_brig_module(brig_container_t handle);
 
 /**
-  *
-  */
+ * Find a module scope symbol (kernel, function or variable) by name.
+ *
+ * When the container includes a symbol index section (see HSAILAsm -symbol-index),
+ * symbols present in the module are found without walking the code section.
+ * Missing names, and names the index gets wrong, are looked up by the walk.
+ *
+ * @param handle - BRIG container handle.
+ * @param symbol_name - name of the symbol including the leading '&'.
+ *
+ * @return - offset of the first directive with this name in the code section, or zero if not found.
+ */
 HSAIL_C_API brig_code_section_offset brig_container_find_code_module_symbol_offset(brig_container_t handle, const char *symbol_name);
 
+/**
+ * Operand kinds of brig_operand_desc.
+ */
+enum brig_operand_desc_kind {
+    BRIG_OPERAND_DESC_NONE = 0,
+    BRIG_OPERAND_DESC_REGISTER,
+    BRIG_OPERAND_DESC_IMMED,
+    BRIG_OPERAND_DESC_ADDRESS,
+    BRIG_OPERAND_DESC_LABEL,
+    BRIG_OPERAND_DESC_CODE_REF,
+    BRIG_OPERAND_DESC_CODE_LIST,     /* elements are all CODE_REF or all LABEL */
+    BRIG_OPERAND_DESC_OPERAND_LIST,
+    BRIG_OPERAND_DESC_WAVESIZE
+};
+
+/**
+ * Operand descriptor. Which fields are used depends on the kind.
+ */
+typedef struct brig_operand_desc {
+    uint32_t kind;        /* brig_operand_desc_kind */
+    uint32_t type;        /* IMMED: BrigType of the value */
+    uint32_t reg_kind;    /* REGISTER: BrigRegisterKind */
+    uint32_t reg_num;     /* REGISTER: register number */
+    uint64_t value;       /* IMMED: the value if it fits 64 bits; ADDRESS: offset */
+    const void* bytes;    /* IMMED: the value of wider types, NULL otherwise */
+    const char* name;     /* ADDRESS: symbol or NULL; LABEL: label; CODE_REF: any directive */
+    const struct brig_operand_desc* elements; /* ADDRESS: base register or NULL; lists: elements */
+    uint32_t num_elements;
+} brig_operand_desc;
+
+/**
+ * Instruction descriptor. Fields not present in the instruction format are ignored.
+ */
+typedef struct brig_inst_desc {
+    uint16_t kind;        /* BrigKind of the instruction format */
+    uint16_t opcode;
+    uint16_t type;
+    uint16_t source_type; /* also imageType of IMAGE/QUERY_IMAGE, signalType of SIGNAL */
+    uint16_t coord_type;
+    uint8_t  segment;
+    uint8_t  align;
+    uint8_t  width;
+    uint8_t  equiv_class;
+    uint8_t  modifier;    /* raw bits of the ALU, memory or segment conversion modifier */
+    uint8_t  round;
+    uint8_t  pack;
+    uint8_t  compare;
+    uint8_t  memory_order;
+    uint8_t  memory_scope; /* also globalSegmentMemoryScope of MEM_FENCE */
+    uint8_t  group_segment_memory_scope;
+    uint8_t  image_segment_memory_scope;
+    uint8_t  atomic_operation; /* also signalOperation of SIGNAL */
+    uint8_t  geometry;
+    uint8_t  query;       /* imageQuery or samplerQuery */
+    const char* label;    /* label defined at the instruction or NULL */
+    const brig_operand_desc* operands;
+    uint32_t num_operands;
+} brig_inst_desc;
+
+/**
+ * Roles of variables added with brig_container_build_variable.
+ */
+enum brig_variable_role {
+    BRIG_VARIABLE_PLAIN = 0,
+    BRIG_VARIABLE_INPUT_PARAMETER,
+    BRIG_VARIABLE_OUTPUT_PARAMETER
+};
+
+/**
+ * Start building a program in an empty BRIG container without HSAIL text.
+ *
+ * The brig_container_build_* functions emit BRIG in the order of
+ * HSAIL statements. Instructions are passed in batches of descriptors;
+ * operands equal to ones emitted before are shared.
+ *
+ * @param handle - BRIG container handle.
+ *
+ * @return zero on success, or a non-zero error code on failure. Use brig_container_get_error_text() to receive further error info.
+ */
+HSAIL_C_API int         brig_container_build_start(brig_container_t handle);
+
+/**
+ * Emit the module statement.
+ *
+ * @param handle - BRIG container handle.
+ * @param name - module name including '&'.
+ * @param machine_model - BrigMachineModel value.
+ * @param profile - BrigProfile value.
+ * @param default_rounding - BrigRound value.
+ *
+ * @return zero on success, or a non-zero error code on failure.
+ */
+HSAIL_C_API int         brig_container_build_module(brig_container_t handle, const char* name, unsigned major, unsigned minor,
+                                                    unsigned machine_model, unsigned profile, unsigned default_rounding);
+
+/**
+ * Declare a kernel, function, indirect function or signature. Parameters
+ * follow as variables, the body (if any) follows the parameters. Not
+ * allowed inside a body.
+ *
+ * @param handle - BRIG container handle.
+ * @param kind - BrigKind of the directive.
+ * @param name - name including '&'.
+ * @param linkage - BrigLinkage value.
+ *
+ * @return zero on success, or a non-zero error code on failure.
+ */
+HSAIL_C_API int         brig_container_build_executable(brig_container_t handle, unsigned kind, const char* name, unsigned linkage);
+
+/**
+ * Emit a variable definition.
+ *
+ * @param handle - BRIG container handle.
+ * @param name - name including '&' or '%'.
+ * @param segment - BrigSegment value.
+ * @param type - BrigType of the variable or of the array elements.
+ * @param dim - number of array elements, zero for scalars.
+ * @param role - brig_variable_role value.
+ *
+ * @return zero on success, or a non-zero error code on failure.
+ */
+HSAIL_C_API int         brig_container_build_variable(brig_container_t handle, const char* name, unsigned segment, unsigned type,
+                                                      uint64_t dim, unsigned role);
+
+/**
+ * Start and end the body of the executable declared last. Bodies cannot
+ * be nested and must not end inside an argument scope.
+ *
+ * @return zero on success, or a non-zero error code on failure.
+ */
+HSAIL_C_API int         brig_container_build_start_body(brig_container_t handle);
+HSAIL_C_API int         brig_container_build_end_body(brig_container_t handle);
+
+/**
+ * Start and end an argument scope. Argument scopes are only allowed in
+ * a body and cannot be nested.
+ *
+ * @return zero on success, or a non-zero error code on failure.
+ */
+HSAIL_C_API int         brig_container_build_start_arg_scope(brig_container_t handle);
+HSAIL_C_API int         brig_container_build_end_arg_scope(brig_container_t handle);
+
+/**
+ * Emit a batch of instructions to the current body. Fails if no body
+ * has been started.
+ *
+ * @param handle - BRIG container handle.
+ * @param insts - instruction descriptors.
+ * @param num_insts - number of descriptors.
+ *
+ * @return zero on success, or a non-zero error code on failure.
+ */
+HSAIL_C_API int         brig_container_build_insts(brig_container_t handle, const brig_inst_desc* insts, size_t num_insts);
+
+/**
+ * Finish building the program. Fails if a body or an argument scope
+ * has not been ended.
+ *
+ * @param handle - BRIG container handle.
+ *
+ * @return zero on success, or a non-zero error code on failure.
+ */
+HSAIL_C_API int         brig_container_build_end(brig_container_t handle);
+
 /**
  * Obtain error message text.
  *